@@ -0,0 +1,158 @@
+// Conversor de los dibujos en Python turtle al formato de dibujo del plotter (Laboratorio 2 - Problema A)
+// Compilar (Linux):  g++ -std=c++17 -O2 -o convertir_turtle convertir_turtle.cpp
+//
+// Uso:
+//   ./convertir_turtle ../Codigo_PythonTurtle_Gato [opciones] > dibujo_gato.inc
+//     --nombre N           nombre del arreglo (por defecto dibujo_ + lo que sigue al último '_')
+//     --pasos-por-cm N     pasos del plotter por cm (por defecto 12, el de Codigo_Plotter)
+//     --diagonal-turtle    mover_diag_*(cm) avanza cm sobre la diagonal, como en turtle; por
+//                          defecto avanza cm en cada eje, como las funciones del plotter
+// Escribe en la salida estándar el arreglo PROGMEM, listo para pegar en Codigo_Plotter, y en la de
+// errores su tamaño y los pasos con el lápiz abajo y arriba.
+//
+// Del script se leen las llamadas mover_*(cm), t.penup() y t.pendown(); lo demás se ignora.
+// Las posiciones se redondean a pasos en absoluto, así que los redondeos no se acumulan.
+//
+// Formato (ver dibujo_reproducir() en Codigo_Plotter): pares de bytes con signo (dx, dy) en pasos,
+// x a la derecha e y hacia arriba, de -127 a 127 (las rectas más largas se parten). Un par que
+// empieza con -128 es un comando: DIB_SUBIR (0), DIB_BAJAR (1) o DIB_FIN (2). Empieza con el lápiz
+// arriba en el punto de partida.
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <regex>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr int COMANDO = -128;
+enum { SUBIR = 0, BAJAR = 1, FIN = 2 };
+
+struct Par { int a, b; };
+
+bool leer_script(const std::string &archivo, double pasos_cm, bool diagonal_turtle, std::vector<Par> &d) {
+	std::ifstream f(archivo);
+	if (!f) { std::perror(archivo.c_str()); return false; }
+	const std::regex mover(R"(^\s+mover_(\w+)\(\s*([0-9]*\.?[0-9]+)\s*\))");
+	const double k = diagonal_turtle ? std::sqrt(0.5) : 1.0;
+	double x = 0, y = 0;        // cm
+	long px = 0, py = 0;        // pasos ya emitidos
+	bool abajo = false, pendiente_bajar = true;   // turtle empieza con el lápiz abajo
+	std::string linea;
+	for (int n = 1; std::getline(f, linea); n++) {
+		std::smatch m;
+		if (linea.find("penup()") != std::string::npos) { pendiente_bajar = false; if (abajo) { d.push_back({COMANDO, SUBIR}); abajo = false; } continue; }
+		if (linea.find("pendown()") != std::string::npos) { pendiente_bajar = true; continue; }
+		if (!std::regex_search(linea, m, mover)) continue;
+		std::string dir = m[1];
+		double v = std::stod(m[2]);
+		double dx, dy;
+		if (dir == "derecha") { dx = 1; dy = 0; }
+		else if (dir == "izquierda") { dx = -1; dy = 0; }
+		else if (dir == "arriba") { dx = 0; dy = 1; }
+		else if (dir == "abajo") { dx = 0; dy = -1; }
+		else if (dir == "diag_arriba_der") { dx = k; dy = k; }
+		else if (dir == "diag_arriba_izq") { dx = -k; dy = k; }
+		else if (dir == "diag_abajo_der") { dx = k; dy = -k; }
+		else if (dir == "diag_abajo_izq") { dx = -k; dy = -k; }
+		else { std::fprintf(stderr, "%s:%d: movimiento desconocido mover_%s\n", archivo.c_str(), n, dir.c_str()); return false; }
+		if (pendiente_bajar && !abajo) { d.push_back({COMANDO, BAJAR}); abajo = true; }
+		x += dx * v;
+		y += dy * v;
+		long nx = std::lround(x * pasos_cm), ny = std::lround(y * pasos_cm);
+		long ddx = nx - px, ddy = ny - py;
+		// Partir en tramos de hasta 127 pasos sobre la misma recta
+		long tramos = (std::max(std::labs(ddx), std::labs(ddy)) + 126) / 127;
+		for (long t = 1; t <= tramos; t++) {
+			long tx = px + ddx * t / tramos, ty = py + ddy * t / tramos;
+			long ax = px + ddx * (t - 1) / tramos, ay = py + ddy * (t - 1) / tramos;
+			d.push_back({(int)(tx - ax), (int)(ty - ay)});
+		}
+		px = nx;
+		py = ny;
+	}
+	if (abajo) d.push_back({COMANDO, SUBIR});
+	d.push_back({COMANDO, FIN});
+	return true;
+}
+
+// Junta rectas seguidas en el mismo sentido (mismo lápiz) mientras entren en un byte
+std::vector<Par> juntar(const std::vector<Par> &d) {
+	std::vector<Par> r;
+	for (const Par &p : d) {
+		if (p.a != COMANDO && !r.empty() && r.back().a != COMANDO) {
+			Par &q = r.back();
+			bool paralelas = (long)q.a * p.b == (long)q.b * p.a && (long)q.a * p.a + (long)q.b * p.b > 0;
+			if (paralelas && std::abs(q.a + p.a) <= 127 && std::abs(q.b + p.b) <= 127) {
+				q.a += p.a;
+				q.b += p.b;
+				continue;
+			}
+		}
+		r.push_back(p);
+	}
+	return r;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+	if (argc < 2) {
+		std::fprintf(stderr, "uso: %s script.py [--nombre N] [--pasos-por-cm N] [--diagonal-turtle]\n", argv[0]);
+		return 1;
+	}
+	std::string archivo = argv[1];
+	size_t guion = archivo.find_last_of('_');
+	std::string nombre = "dibujo_" + archivo.substr(guion == std::string::npos ? 0 : guion + 1);
+	for (char &c : nombre) c = (char)std::tolower((unsigned char)c);
+	double pasos_cm = 12;
+	bool diagonal_turtle = false;
+	for (int i = 2; i < argc; i++) {
+		std::string a = argv[i];
+		if (a == "--nombre" && i + 1 < argc) nombre = argv[++i];
+		else if (a == "--pasos-por-cm" && i + 1 < argc) pasos_cm = std::atof(argv[++i]);
+		else if (a == "--diagonal-turtle") diagonal_turtle = true;
+		else { std::fprintf(stderr, "Opción desconocida: %s\n", a.c_str()); return 1; }
+	}
+
+	std::vector<Par> d;
+	if (!leer_script(archivo, pasos_cm, diagonal_turtle, d)) return 1;
+	d = juntar(d);
+
+	long pasos_abajo = 0, pasos_arriba = 0;
+	int rectas = 0, levantadas = 0;
+	bool abajo = false;
+	for (const Par &p : d) {
+		if (p.a == COMANDO) {
+			if (p.b == BAJAR) abajo = true;
+			if (p.b == SUBIR) { abajo = false; levantadas++; }
+			continue;
+		}
+		rectas++;
+		long n = std::max(std::abs(p.a), std::abs(p.b));
+		(abajo ? pasos_abajo : pasos_arriba) += n;
+	}
+
+	std::printf("// Generado con convertir_turtle a partir de %s: %d rectas, %zu bytes\n",
+		archivo.c_str(), rectas, d.size() * 2);
+	std::printf("const int8_t %s[] PROGMEM = {", nombre.c_str());
+	for (size_t i = 0; i < d.size(); i++) {
+		char buf[32];
+		if (d[i].a == COMANDO) {
+			static const char *cmd[] = {"DIB_SUBIR", "DIB_BAJAR", "DIB_FIN"};
+			std::snprintf(buf, sizeof buf, "DIB_COMANDO, %s", cmd[d[i].b]);
+		} else {
+			std::snprintf(buf, sizeof buf, "%d, %d", d[i].a, d[i].b);
+		}
+		std::printf("%s%s", (i % 8) ? ",  " : (i ? ",\n    " : "\n    "), buf);
+	}
+	std::printf("\n};\n\n");
+	std::fprintf(stderr, "%s: %d rectas, %d levantadas, %ld pasos dibujando y %ld en el aire, %zu bytes\n",
+		nombre.c_str(), rectas, levantadas, pasos_abajo, pasos_arriba, d.size() * 2);
+	return 0;
+}
@@ -0,0 +1,300 @@
+// Optimizador del recorrido en el aire de los dibujos del plotter (Laboratorio 2 - Problema A)
+// Compilar (Linux):  g++ -std=c++17 -O2 -o optimizar_recorrido optimizar_recorrido.cpp
+//
+// Uso:
+//   ./optimizar_recorrido ../Codigo_Plotter [otro.inc ...] [opciones] > dibujos.inc
+//     --sin-invertir       no recorrer trazos al revés (solo cambiar el orden)
+//     --ms-paso N          duración de un paso (por defecto 600: pulso de 500 ms + pausa de 100 ms
+//                          de paso_dibujo() en Codigo_Plotter)
+//     --ms-lapiz N         duración de subir o bajar el lápiz (por defecto 800)
+// Lee los arreglos "const int8_t nombre[] PROGMEM = {...}" en el formato de dibujo (el que escribe
+// convertir_turtle, o el mismo Codigo_Plotter) y escribe en la salida estándar los mismos dibujos
+// con los trazos reordenados, listos para pegar en Codigo_Plotter. En la de errores va el tiempo
+// estimado de cada dibujo antes y después.
+//
+// Un trazo es lo que se dibuja entre bajar y subir el lápiz. Se empieza por el vecino más cercano
+// desde el origen (donde arranca el plotter), eligiendo también el sentido de cada trazo, y después
+// se mejora con 2-opt: dar vuelta un tramo de la secuencia (y el sentido de sus trazos) mientras
+// baje el tiempo total. Un paso diagonal mueve los dos motores a la vez, así que un viaje en el aire
+// de (dx, dy) cuesta max(|dx|, |dy|) pasos. Si un trazo termina donde empieza el siguiente no se
+// levanta el lápiz.
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <regex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr int COMANDO = -128;
+enum { SUBIR = 0, BAJAR = 1, FIN = 2 };
+
+struct Par { int a, b; };
+
+struct Punto {
+	long x = 0, y = 0;
+	bool operator==(const Punto &o) const { return x == o.x && y == o.y; }
+};
+
+struct Trazo {
+	Punto inicio, fin;
+	std::vector<Par> rectas;
+};
+
+// Un trazo en la secuencia: cuál y si se recorre al revés
+struct Visita { int trazo; bool invertido; };
+
+struct Dibujo {
+	std::string nombre;
+	std::vector<Par> datos;
+	std::vector<Trazo> trazos;
+};
+
+struct Tiempo {
+	long pasos_abajo = 0, pasos_aire = 0;
+	int lapiz = 0;    // Movimientos del lápiz (bajar o subir)
+	double segundos(double ms_paso, double ms_lapiz) const {
+		return ((pasos_abajo + pasos_aire) * ms_paso + lapiz * ms_lapiz) / 1000;
+	}
+};
+
+long pasos(long dx, long dy) { return std::max(std::labs(dx), std::labs(dy)); }
+
+bool leer_archivo(const std::string &archivo, std::vector<Dibujo> &dibujos) {
+	std::ifstream f(archivo);
+	if (!f) { std::perror(archivo.c_str()); return false; }
+	std::stringstream ss;
+	ss << f.rdbuf();
+	std::string texto = ss.str();
+	const std::regex arreglo(R"(const\s+int8_t\s+(\w+)\s*\[\]\s*PROGMEM\s*=\s*\{([^}]*)\})");
+	for (std::sregex_iterator it(texto.begin(), texto.end(), arreglo), fin; it != fin; ++it) {
+		Dibujo d;
+		d.nombre = (*it)[1];
+		std::vector<int> v;
+		std::stringstream cuerpo((*it)[2]);
+		std::string t;
+		while (std::getline(cuerpo, t, ',')) {
+			t.erase(0, t.find_first_not_of(" \t\r\n"));
+			t.erase(t.find_last_not_of(" \t\r\n") + 1);
+			if (t.empty()) continue;
+			if (t == "DIB_COMANDO") v.push_back(COMANDO);
+			else if (t == "DIB_SUBIR") v.push_back(SUBIR);
+			else if (t == "DIB_BAJAR") v.push_back(BAJAR);
+			else if (t == "DIB_FIN") v.push_back(FIN);
+			else v.push_back(std::atoi(t.c_str()));
+		}
+		if (v.size() % 2) {
+			std::fprintf(stderr, "%s: %s tiene una cantidad impar de bytes\n", archivo.c_str(), d.nombre.c_str());
+			return false;
+		}
+		for (size_t i = 0; i < v.size(); i += 2) d.datos.push_back({v[i], v[i + 1]});
+		dibujos.push_back(d);
+	}
+	return true;
+}
+
+// Separa los trazos y mide el dibujo tal como está
+Tiempo analizar(Dibujo &d) {
+	Tiempo t;
+	Punto p;
+	bool abajo = false;
+	for (const Par &q : d.datos) {
+		if (q.a == COMANDO) {
+			if (q.b == FIN) break;
+			if (q.b == BAJAR && !abajo) {
+				abajo = true;
+				t.lapiz++;
+				d.trazos.push_back({p, p, {}});
+			} else if (q.b == SUBIR && abajo) {
+				abajo = false;
+				t.lapiz++;
+			}
+			continue;
+		}
+		p.x += q.a;
+		p.y += q.b;
+		if (abajo) {
+			t.pasos_abajo += pasos(q.a, q.b);
+			d.trazos.back().rectas.push_back(q);
+			d.trazos.back().fin = p;
+		} else {
+			t.pasos_aire += pasos(q.a, q.b);
+		}
+	}
+	if (abajo) t.lapiz++;    // dibujo_reproducir() sube el lápiz al final
+	return t;
+}
+
+Punto inicio_de(const Dibujo &d, const Visita &v) {
+	const Trazo &t = d.trazos[v.trazo];
+	return v.invertido ? t.fin : t.inicio;
+}
+
+Punto fin_de(const Dibujo &d, const Visita &v) {
+	const Trazo &t = d.trazos[v.trazo];
+	return v.invertido ? t.inicio : t.fin;
+}
+
+// Tiempo (ms) de una secuencia: viajes en el aire y levantadas; lo dibujado no cambia
+double costo(const Dibujo &d, const std::vector<Visita> &s, double ms_paso, double ms_lapiz) {
+	double c = 0;
+	Punto p;
+	for (size_t i = 0; i < s.size(); i++) {
+		Punto a = inicio_de(d, s[i]);
+		long viaje = pasos(a.x - p.x, a.y - p.y);
+		c += viaje * ms_paso;
+		if (i == 0 || viaje) c += 2 * ms_lapiz;    // Bajar aquí y subir al final del anterior
+		p = fin_de(d, s[i]);
+	}
+	return c;
+}
+
+std::vector<Visita> vecino_mas_cercano(const Dibujo &d, bool invertir) {
+	std::vector<Visita> s;
+	std::vector<bool> usado(d.trazos.size(), false);
+	Punto p;
+	for (size_t n = 0; n < d.trazos.size(); n++) {
+		Visita mejor{-1, false};
+		long mejor_dist = 0;
+		for (size_t i = 0; i < d.trazos.size(); i++) {
+			if (usado[i]) continue;
+			for (int inv = 0; inv <= (invertir ? 1 : 0); inv++) {
+				Visita v{(int)i, inv != 0};
+				Punto a = inicio_de(d, v);
+				long dist = pasos(a.x - p.x, a.y - p.y);
+				if (mejor.trazo < 0 || dist < mejor_dist) { mejor = v; mejor_dist = dist; }
+			}
+		}
+		usado[mejor.trazo] = true;
+		s.push_back(mejor);
+		p = fin_de(d, mejor);
+	}
+	return s;
+}
+
+// 2-opt: dar vuelta s[i..j]. Sin invertir trazos el tramo se recorre en orden inverso pero cada
+// trazo en su sentido original. Con invertir además se prueba dar vuelta cada trazo solo.
+void dos_opt(const Dibujo &d, std::vector<Visita> &s, bool invertir, double ms_paso, double ms_lapiz) {
+	double actual = costo(d, s, ms_paso, ms_lapiz);
+	for (bool mejoro = true; mejoro;) {
+		mejoro = false;
+		for (size_t i = 0; i < s.size(); i++) {
+			for (size_t j = i; j < s.size(); j++) {
+				if (i == j && !invertir) continue;
+				std::vector<Visita> c = s;
+				std::reverse(c.begin() + i, c.begin() + j + 1);
+				if (invertir)
+					for (size_t k = i; k <= j; k++) c[k].invertido = !c[k].invertido;
+				double nuevo = costo(d, c, ms_paso, ms_lapiz);
+				if (nuevo < actual - 1e-9) {
+					s = c;
+					actual = nuevo;
+					mejoro = true;
+				}
+			}
+		}
+	}
+}
+
+// Viaje en línea recta partido en tramos de hasta 127 pasos
+void viaje(std::vector<Par> &r, long dx, long dy) {
+	long tramos = (pasos(dx, dy) + 126) / 127;
+	for (long t = 1; t <= tramos; t++) {
+		r.push_back({(int)(dx * t / tramos - dx * (t - 1) / tramos), (int)(dy * t / tramos - dy * (t - 1) / tramos)});
+	}
+}
+
+std::vector<Par> armar(const Dibujo &d, const std::vector<Visita> &s, Tiempo &t) {
+	std::vector<Par> r;
+	Punto p;
+	bool abajo = false;
+	for (const Visita &v : s) {
+		const Trazo &tr = d.trazos[v.trazo];
+		Punto a = inicio_de(d, v);
+		if (!abajo || !(a == p)) {
+			if (abajo) { r.push_back({COMANDO, SUBIR}); t.lapiz++; }
+			viaje(r, a.x - p.x, a.y - p.y);
+			t.pasos_aire += pasos(a.x - p.x, a.y - p.y);
+			r.push_back({COMANDO, BAJAR});
+			t.lapiz++;
+			abajo = true;
+		}
+		if (v.invertido) {
+			for (auto it = tr.rectas.rbegin(); it != tr.rectas.rend(); ++it) r.push_back({-it->a, -it->b});
+		} else {
+			r.insert(r.end(), tr.rectas.begin(), tr.rectas.end());
+		}
+		for (const Par &q : tr.rectas) t.pasos_abajo += pasos(q.a, q.b);
+		p = fin_de(d, v);
+	}
+	if (abajo) { r.push_back({COMANDO, SUBIR}); t.lapiz++; }
+	r.push_back({COMANDO, FIN});
+	return r;
+}
+
+void escribir(const std::string &archivo, const Dibujo &d, const std::vector<Par> &r) {
+	std::printf("// Generado con optimizar_recorrido a partir de %s (%s): %zu trazos, %zu bytes\n",
+		archivo.c_str(), d.nombre.c_str(), d.trazos.size(), r.size() * 2);
+	std::printf("const int8_t %s[] PROGMEM = {", d.nombre.c_str());
+	for (size_t i = 0; i < r.size(); i++) {
+		char buf[32];
+		if (r[i].a == COMANDO) {
+			static const char *cmd[] = {"DIB_SUBIR", "DIB_BAJAR", "DIB_FIN"};
+			std::snprintf(buf, sizeof buf, "DIB_COMANDO, %s", cmd[r[i].b]);
+		} else {
+			std::snprintf(buf, sizeof buf, "%d, %d", r[i].a, r[i].b);
+		}
+		std::printf("%s%s", (i % 8) ? ",  " : (i ? ",\n    " : "\n    "), buf);
+	}
+	std::printf("\n};\n\n");
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+	std::vector<std::string> archivos;
+	bool invertir = true;
+	double ms_paso = 600, ms_lapiz = 800;
+	for (int i = 1; i < argc; i++) {
+		std::string a = argv[i];
+		if (a == "--sin-invertir") invertir = false;
+		else if (a == "--ms-paso" && i + 1 < argc) ms_paso = std::atof(argv[++i]);
+		else if (a == "--ms-lapiz" && i + 1 < argc) ms_lapiz = std::atof(argv[++i]);
+		else if (a.rfind("--", 0) == 0) { std::fprintf(stderr, "Opción desconocida: %s\n", a.c_str()); return 1; }
+		else archivos.push_back(a);
+	}
+	if (archivos.empty()) {
+		std::fprintf(stderr, "uso: %s archivo [otro ...] [--sin-invertir] [--ms-paso N] [--ms-lapiz N]\n", argv[0]);
+		return 1;
+	}
+
+	int errores = 0;
+	for (const std::string &archivo : archivos) {
+		std::vector<Dibujo> dibujos;
+		if (!leer_archivo(archivo, dibujos)) { errores++; continue; }
+		if (dibujos.empty()) std::fprintf(stderr, "%s: no tiene arreglos de dibujo\n", archivo.c_str());
+		for (Dibujo &d : dibujos) {
+			Tiempo antes = analizar(d);
+			std::vector<Visita> s = vecino_mas_cercano(d, invertir);
+			dos_opt(d, s, invertir, ms_paso, ms_lapiz);
+			Tiempo despues;
+			std::vector<Par> r = armar(d, s, despues);
+			// Si el orden original ya era mejor (p. ej. viajes que no son en línea recta) se deja
+			if (despues.segundos(ms_paso, ms_lapiz) > antes.segundos(ms_paso, ms_lapiz)) {
+				r = d.datos;
+				despues = antes;
+			}
+			escribir(archivo, d, r);
+			double ta = antes.segundos(ms_paso, ms_lapiz), td = despues.segundos(ms_paso, ms_lapiz);
+			std::fprintf(stderr, "%s: %zu trazos, %ld pasos dibujando; en el aire %ld -> %ld pasos, "
+				"lápiz %d -> %d veces; tiempo estimado %.0f s -> %.0f s (%.1f%% menos)\n",
+				d.nombre.c_str(), d.trazos.size(), antes.pasos_abajo, antes.pasos_aire, despues.pasos_aire,
+				antes.lapiz, despues.lapiz, ta, td, ta > 0 ? 100 * (ta - td) / ta : 0.0);
+		}
+	}
+	return errores ? 1 : 0;
+}
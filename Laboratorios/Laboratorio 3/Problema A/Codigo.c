@@ -1,7 +1,10 @@
 #define F_CPU 1000000UL
 #include <avr/io.h>
-#include <util/delay_basic.h>
-#include <util/delay.h>
+#include <avr/interrupt.h>
+#include <util/atomic.h>
+#include <math.h>
+#include <stdlib.h>
+#include "circulo.h"
 
 // --- Definiciones de pines para el eje X ---
 #define STEP_X   PB3
@@ -18,11 +21,257 @@
 
 // --- Constantes del sistema ---
 #define PASOS_POR_CM 100
-#define DIAG_CORR 1.1
+#define VELOCIDAD    1000    // Velocidad de crucero sobre el papel (pasos/s: 10 cm/s)
+#define VELOCIDAD_G0 2000    // Movimientos rápidos (G0)
+#define VELOCIDAD_MIN ((uint16_t)(F_CPU * 1.415 / 65535) + 1)   // 22: más lento, el crucero de una diagonal no entra en 16 bits
+#define ACELERACION  10000   // Pasos/s^2 (1 m/s^2)
+#define C_MIN        250     // Piso del intervalo (µs); con RAMPA_MAX 256 no se llega (ver "Máximo")
+#define RAMPA_MAX    256     // Pasos de la rampa (llega a ~2260 pasos/s con ACELERACION)
+#define COLA_LARGO   16      // Segmentos planificados (potencia de 2)
+#define ESPERA_LAPIZ 2       // Vueltas de 50 ms que se espera al servo del lápiz
+#define DESVIO_ESQUINA 2.0   // Desvío de la trayectoria tolerado en una esquina (pasos)
+#define ARCO_CUERDA_PASOS 8  // Pasos de la trama de un arco que se juntan en cada recta
+
+// --- UART: 9600 baudios con U2X (a 1 MHz sin U2X el error es de 7 %) ---
+#define BAUD 9600
+#define UBRR_VALUE ((F_CPU / 8 / BAUD) - 1)
+#define RX_TAM 128   // Potencia de 2; es también la ventana del conteo de caracteres del host
+#define LINEA_MAX 80
 
-// --- Retardo personalizado para sincronización fina ---
-static inline void custom_delay(uint16_t cycles) {
-	_delay_loop_2(cycles); 
+// -----------------------------------------------------------
+// MOTOR DE PASOS POR INTERRUPCIÓN
+// -----------------------------------------------------------
+// El Timer1 (CTC, sin prescaler: 1 tick = 1 µs) interrumpe en cada paso. La ISR saca el pulso
+// que preparó la vez anterior, decide el próximo con Bresenham y carga en OCR1A el tiempo hasta
+// él, así que el programa principal solo arma segmentos y los deja en la cola.
+//
+// Perfil trapezoidal: rampa[k] es el intervalo del paso k acelerando desde cero, calculado al
+// arrancar con la recurrencia entera c(k) = c(k-1) - 2 c(k-1) / (4k + 1) (AVR446; una sola raíz
+// para c(0)). Como k es proporcional a v^2, acelerar o frenar N pasos es sumar o restar N al
+// índice. En el paso i de un segmento de N pasos que entra con índice k_entrada y sale con
+// k_salida se usa
+//     rampa[min(k_entrada + i, k_salida + N-1-i)], o el intervalo de crucero desde k_crucero
+// sin divisiones ni raíces.
+//
+// Máximo: el techo efectivo es el final de la rampa. Con RAMPA_MAX 256 y ACELERACION el último
+// intervalo es ~443 µs (~2260 pasos/s), así que C_MIN no se alcanza y ningún pedido pasa de ahí
+// (VELOCIDAD_G0 = 2000 entra). La ISR son ~130 ciclos estimados, no medidos (a 1 MHz, ~130 µs)
+// entre entrada, Bresenham, buscar el intervalo y la salida: a 2260 pasos/s usa ~30 % de la CPU.
+// Con PLOTTER_MEDIR_ISR definido, isr_us_max guarda el mayor TCNT1 al terminar la ISR (latencia
+// + duración, en µs; se lee con '?'): la ISR aguanta hasta ~1000000 / isr_us_max pasos/s.
+enum { SEG_RECTA, SEG_LAPIZ };
+
+typedef struct {
+	int16_t dx, dy;       // Pasos (SEG_RECTA); dx = 1 baja el lápiz (SEG_LAPIZ)
+	uint8_t tipo;
+	uint16_t mayor;       // Pasos del eje mayor
+	uint16_t k_crucero;   // Índice de la rampa donde se llega al crucero
+	uint16_t c_crucero;   // Intervalo de crucero (µs)
+	uint16_t k_esquina;   // Entrada máxima por el ángulo con el segmento anterior
+	uint16_t k_salida_max;   // Salida máxima para poder frenar antes del fin de la cola
+	uint16_t k_entrada, k_salida;   // Plan actual (la ISR los copia al cargar el segmento)
+} Segmento;
+
+static Segmento cola[COLA_LARGO];
+static volatile uint8_t cola_cabeza, cola_cola;
+static volatile uint8_t motor_activo;
+
+static uint16_t rampa[RAMPA_MAX];
+static uint16_t rampa_largo;
+
+// Estado del segmento en curso (solo lo toca la ISR)
+static struct {
+	uint16_t mayor, menor, i;
+	int16_t error;
+	uint8_t x_mayor;
+	uint8_t espera;
+	uint16_t k_entrada, k_salida, k_crucero, c_crucero;
+} m;
+static uint8_t pulso_b, pulso_c;   // Pines de STEP a subir en la próxima interrupción
+
+#ifdef PLOTTER_MEDIR_ISR
+volatile uint16_t isr_us_max;
+#endif
+
+void calcular_rampa(void) {
+	uint32_t c = (uint32_t)(0.676 * F_CPU * sqrt(2.0 / ACELERACION) * 256);   // 24.8 bits
+	rampa[0] = c >> 8;
+	for (rampa_largo = 1; rampa_largo < RAMPA_MAX; rampa_largo++) {
+		c -= 2 * c / (4 * rampa_largo + 1);
+		uint16_t intervalo = (c + 128) >> 8;
+		if (intervalo <= C_MIN) {
+			rampa[rampa_largo++] = C_MIN;
+			break;
+		}
+		rampa[rampa_largo] = intervalo;
+	}
+}
+
+// Prepara el paso m.i: pulsos para la próxima interrupción y el tiempo hasta ella.
+// Devuelve 0 si el segmento terminó.
+static inline __attribute__((always_inline)) uint8_t preparar_paso(void) {
+	if (m.i >= m.mayor) return 0;
+	uint16_t k = m.k_salida + (m.mayor - 1 - m.i);   // Frenar a tiempo
+	uint16_t k_acel = m.k_entrada + m.i;
+	if (k_acel < k) k = k_acel;
+	OCR1A = (k >= m.k_crucero) ? m.c_crucero : rampa[k];
+	if (m.x_mayor) pulso_b = (1 << STEP_X);
+	else pulso_c = (1 << STEP_Y);
+	m.error -= m.menor;
+	if (m.error < 0) {
+		m.error += m.mayor;
+		pulso_b = (1 << STEP_X);
+		pulso_c = (1 << STEP_Y);
+	}
+	m.i++;
+	return 1;
+}
+
+// Saca el próximo segmento de la cola; 0 si está vacía
+static inline __attribute__((always_inline)) uint8_t cargar_segmento(void) {
+	uint8_t t = cola_cola;
+	if (t == cola_cabeza) return 0;
+	const Segmento *s = &cola[t];
+	if (s->tipo == SEG_LAPIZ) {
+		if (s->dx) PORTC &= ~(1 << PEN_PIN);   // Baja el lápiz para dibujar
+		else PORTC |= (1 << PEN_PIN);          // Sube el lápiz para moverse sin dibujar
+		m.espera = ESPERA_LAPIZ;
+		m.i = m.mayor = 0;
+		m.k_salida = 0;
+		OCR1A = 50000;
+	} else {
+		// Establecer la dirección del movimiento (el primer pulso sale un intervalo después)
+		if (s->dx >= 0) PORTB |= (1 << DIR_X);
+		else PORTB &= ~(1 << DIR_X);
+		if (s->dy >= 0) PORTC |= (1 << DIR_Y);
+		else PORTC &= ~(1 << DIR_Y);
+		uint16_t ax = (s->dx < 0) ? -s->dx : s->dx;
+		uint16_t ay = (s->dy < 0) ? -s->dy : s->dy;
+		m.x_mayor = (ax >= ay);
+		m.mayor = s->mayor;
+		m.menor = m.x_mayor ? ay : ax;
+		m.error = m.mayor / 2;
+		m.i = 0;
+		m.k_entrada = s->k_entrada;
+		m.k_salida = s->k_salida;
+		m.k_crucero = s->k_crucero;
+		m.c_crucero = s->c_crucero;
+		preparar_paso();
+	}
+	cola_cola = (t + 1) & (COLA_LARGO - 1);
+	return 1;
+}
+
+ISR(TIMER1_COMPA_vect) {
+	PORTB |= pulso_b;   // Pulso preparado en la interrupción anterior
+	PORTC |= pulso_c;
+	pulso_b = pulso_c = 0;
+	if (!preparar_paso()) {
+		if (m.espera && --m.espera) {
+			// Sigue esperando al lápiz (OCR1A queda en 50 ms)
+		} else if (!cargar_segmento()) {
+			TIMSK1 &= ~(1 << OCIE1A);   // Cola vacía: el motor se detiene
+			motor_activo = 0;
+			m.k_salida = 0;
+		}
+	}
+	PORTB &= ~(1 << STEP_X);
+	PORTC &= ~(1 << STEP_Y);
+#ifdef PLOTTER_MEDIR_ISR
+	uint16_t t = TCNT1;
+	if (t > isr_us_max) isr_us_max = t;
+#endif
+}
+
+// -----------------------------------------------------------
+// PLANIFICADOR CON ANTICIPACIÓN
+// -----------------------------------------------------------
+// Cada segmento nuevo vuelve a planificar los que la ISR todavía no cargó, para pasar las esquinas
+// sin detenerse. Todo en índices de la rampa (v^2), así que son sumas y mínimos:
+//   hacia atrás, desde el último (que debe poder terminar parado): la entrada de cada uno no puede
+//   pasar de su esquina, su crucero, ni de la salida permitida + N-1 (frenar dentro del segmento);
+//   hacia adelante, desde la salida del que se está moviendo: la salida de cada uno no puede pasar
+//   de la entrada permitida al siguiente, ni de su propia entrada + N-1 (acelerar dentro).
+// Un segmento que la ISR cargó mientras tanto se deja como estaba: su plan viejo también frenaba a
+// tiempo. El índice se cuenta en pasos del eje mayor, así que en la esquina se conserva la
+// velocidad de ese eje (la del papel cambia a lo sumo un 41 %). El lápiz corta la planificación.
+static uint8_t cola_cargado(uint8_t j) {
+	// 1 si la ISR ya tomó el segmento j (o lo pasó)
+	return ((uint8_t)(j - cola_cola) & (COLA_LARGO - 1)) >= ((uint8_t)(cola_cabeza - cola_cola) & (COLA_LARGO - 1));
+}
+
+static void replanificar(void) {
+	uint8_t cabeza = cola_cabeza;
+	uint8_t primero;
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		primero = cola_cola;
+	}
+	// Hacia atrás
+	uint16_t limite = 0;
+	uint8_t j = cabeza;
+	while (j != primero) {
+		j = (j - 1) & (COLA_LARGO - 1);
+		Segmento *s = &cola[j];
+		if (s->tipo == SEG_LAPIZ) {
+			limite = 0;
+			continue;
+		}
+		s->k_salida_max = (limite > s->k_crucero) ? s->k_crucero : limite;
+		uint32_t entrada = (uint32_t)limite + s->mayor - 1;
+		if (entrada > s->k_esquina) entrada = s->k_esquina;
+		if (entrada > s->k_crucero) entrada = s->k_crucero;
+		limite = entrada;
+	}
+	// Hacia adelante
+	uint16_t entrada;
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		entrada = motor_activo ? m.k_salida : 0;
+	}
+	for (j = primero; j != cabeza; j = (j + 1) & (COLA_LARGO - 1)) {
+		Segmento *s = &cola[j];
+		if (s->tipo == SEG_LAPIZ) {
+			entrada = 0;
+			continue;
+		}
+		ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+			if (!cola_cargado(j)) {
+				uint32_t salida = (uint32_t)entrada + s->mayor - 1;
+				if (salida > s->k_salida_max) salida = s->k_salida_max;
+				s->k_entrada = entrada;
+				s->k_salida = salida;
+			}
+			entrada = s->k_salida;
+		}
+	}
+}
+
+// Pone un segmento en la cola (espera si está llena), replanifica y arranca el motor si estaba
+// parado
+static void encolar(const Segmento *s) {
+	uint8_t c = cola_cabeza;
+	uint8_t siguiente = (c + 1) & (COLA_LARGO - 1);
+	while (siguiente == cola_cola) {
+		// Cola llena: el motor va atrasado
+	}
+	cola[c] = *s;
+	cola[c].k_entrada = cola[c].k_salida = 0;
+	cola_cabeza = siguiente;
+	replanificar();
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		if (!motor_activo) {
+			motor_activo = 1;
+			TCNT1 = 0;
+			OCR1A = 100;   // Primera interrupción enseguida: carga el segmento
+			TIFR1 = (1 << OCF1A);
+			TIMSK1 |= (1 << OCIE1A);
+		}
+	}
+}
+
+// Espera a que se dibuje todo lo encolado
+void esperar_cola(void) {
+	while (motor_activo) {
+	}
 }
 
 // -----------------------------------------------------------
@@ -41,99 +290,175 @@ void setup_plotter(void) {
 	
 	// Subir el lápiz por defecto
 	PORTC |= (1 << PEN_PIN);
+
+	// Timer1 en CTC sin prescaler; la interrupción se habilita al encolar
+	calcular_rampa();
+	TCCR1A = 0;
+	TCCR1B = (1 << WGM12) | (1 << CS10);
+	sei();
 }
 
-// -----------------------------------------------------------
-// FUNCIÓN GENÉRICA PARA MOVER UN MOTOR PASO A PASO
-// -----------------------------------------------------------
-void move_motor(volatile uint8_t *port_dir, uint8_t dir_pin,volatile uint8_t *port_step, uint8_t step_pin, uint8_t direction, uint16_t steps_count) {
-	
-	// Establecer la dirección del movimiento
-	if (direction) *port_dir |= (1 << dir_pin);
-	else *port_dir &= ~(1 << dir_pin);
-	custom_delay(50);
-	
-	// Enviar la cantidad de pasos especificada
-	for (uint16_t i = 0; i < steps_count; i++) {
-		*port_step |= (1 << step_pin);
-		custom_delay(300);
-		*port_step &= ~(1 << step_pin);
-		custom_delay(300);
+// Raíz cuadrada entera redondeada (una por segmento, no por paso)
+static uint16_t raiz_entera(uint32_t n) {
+	uint32_t r = 0, bit = 1UL << 30;
+	while (bit > n) bit >>= 2;
+	while (bit) {
+		if (n >= r + bit) {
+			n -= r + bit;
+			r = (r >> 1) + bit;
+		} else {
+			r >>= 1;
+		}
+		bit >>= 2;
 	}
+	return (uint16_t)(n > r ? r + 1 : r);
 }
 
 // -----------------------------------------------------------
-// MOVER SEGÚN EL EJE (0 = X, 1 = Y)
+// RECTA COORDINADA DE dx, dy PASOS (con signo)
 // -----------------------------------------------------------
-void move_axis(uint8_t axis, uint8_t direction, uint16_t steps) {
-	if (axis == 0) 
-		move_motor(&PORTB, DIR_X, &PORTB, STEP_X, direction, steps);
-	else 
-		move_motor(&PORTC, DIR_Y, &PORTC, STEP_Y, direction, steps);
+// La ISR la recorre con Bresenham entero: el eje mayor da un paso en cada interrupción y el menor
+// cuando el error acumulado pasa de la mitad, así que sale recta en cualquier ángulo. Para que la
+// velocidad sobre el papel sea la misma en cualquier ángulo, el intervalo de crucero se estira por
+// largo / pasos del eje mayor (1 a 1,41).
+static int32_t pos_x, pos_y;           // Posición de la pluma (pasos)
+static int16_t ant_dx, ant_dy;         // Dirección del segmento anterior (0, 0: venía parado)
+static uint16_t ant_largo;
+static uint8_t lapiz_abajo;
+
+void recta(int16_t dx, int16_t dy, uint16_t velocidad) {
+	uint16_t ax = (dx < 0) ? -dx : dx;
+	uint16_t ay = (dy < 0) ? -dy : dy;
+	uint16_t mayor = (ax >= ay) ? ax : ay;
+	if (mayor == 0) return;
+	pos_x += dx;
+	pos_y += dy;
+
+	if (velocidad < VELOCIDAD_MIN) velocidad = VELOCIDAD_MIN;
+	Segmento s = { dx, dy, SEG_RECTA, mayor };
+	uint16_t largo = raiz_entera((uint32_t)ax * ax + (uint32_t)ay * ay);
+	uint32_t c = ((uint32_t)(F_CPU / velocidad) * largo + mayor / 2) / mayor;
+	if (c < rampa[rampa_largo - 1]) c = rampa[rampa_largo - 1];   // No pasar del final de la rampa
+	if (c > 0xFFFF) c = 0xFFFF;
+	s.c_crucero = c;
+
+	// Primer paso de la rampa que ya es tan rápido como el crucero (búsqueda binaria)
+	uint16_t a = 0, b = rampa_largo - 1;
+	while (a < b) {
+		uint16_t medio = (a + b) / 2;
+		if (rampa[medio] <= c) b = medio;
+		else a = medio + 1;
+	}
+	s.k_crucero = a;
+
+	// Esquina con el anterior (desvío de la trayectoria, como en grbl): con s = sen(ángulo / 2)
+	// entre las dos direcciones, v^2 = 2 a * DESVIO * s / (1 - s) / 2, o sea k = DESVIO / 2 * s / (1 - s)
+	s.k_esquina = 0;
+	if (ant_largo) {
+		float coseno = -((float)ant_dx * dx + (float)ant_dy * dy) / ((float)ant_largo * largo);
+		float seno_medio = sqrt((1.0 - coseno) * 0.5);
+		if (seno_medio > 0.999) s.k_esquina = s.k_crucero;   // Casi recto
+		else if (seno_medio > 0.01) {
+			float k = DESVIO_ESQUINA * 0.5 * seno_medio / (1.0 - seno_medio);
+			s.k_esquina = (k > s.k_crucero) ? s.k_crucero : (uint16_t)k;
+		}
+	}
+	ant_dx = dx;
+	ant_dy = dy;
+	ant_largo = largo;
+	encolar(&s);
 }
 
+void line_to(int16_t dx, int16_t dy) {
+	recta(dx, dy, VELOCIDAD);
+}
 
 // -----------------------------------------------------------
 // CONTROL DEL LÁPIZ (PLUMA)
 // -----------------------------------------------------------
+// Van por la cola, en orden con las rectas; la esquina siguiente arranca desde parado
+static void lapiz(uint8_t abajo) {
+	if (abajo == lapiz_abajo) return;
+	lapiz_abajo = abajo;
+	Segmento s = { abajo, 0, SEG_LAPIZ };
+	ant_largo = 0;
+	encolar(&s);
+}
+
 void lower_pen(void) { 
-	PORTC &= ~(1 << PEN_PIN);   // Baja el lápiz para dibujar
-	_delay_ms(100); 
+	lapiz(1);
 }
 
 void lift_pen(void)  { 
-	PORTC |= (1 << PEN_PIN);   // Sube el lápiz para moverse sin dibujar
-	_delay_ms(100); 
+	lapiz(0);
+}
+
+// -----------------------------------------------------------
+// ARCOS
+// -----------------------------------------------------------
+// circulo.h da la trama de pasos del círculo con enteros (punto medio) y acá se junta de a
+// ARCO_CUERDA_PASOS pasos en rectas para la cola: cada extremo está a menos de medio paso del
+// círculo y el último es el punto final exacto, así que un círculo cierra donde empezó.
+static int16_t cuerda_dx, cuerda_dy;
+static uint8_t cuerda_pasos;
+static uint16_t cuerda_velocidad;
+
+static void cerrar_cuerda(void) {
+	recta(cuerda_dx, cuerda_dy, cuerda_velocidad);
+	cuerda_dx = cuerda_dy = 0;
+	cuerda_pasos = 0;
+}
+
+static void paso_arco(int8_t dx, int8_t dy) {
+	cuerda_dx += dx;
+	cuerda_dy += dy;
+	if (++cuerda_pasos == ARCO_CUERDA_PASOS) cerrar_cuerda();
+}
+
+// Arco desde la posición actual, que está en (x0, y0) respecto del centro, hasta (x1, y1)
+void arco_pasos(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint8_t horario, uint16_t velocidad) {
+	cuerda_velocidad = velocidad;
+	arco_trazar(x0, y0, x1, y1, horario, paso_arco);
+	cerrar_cuerda();
 }
 
 // -------------------- MOVIMIENTOS BÁSICOS --------------------
+static inline int16_t pasos(float cm) {
+	return (int16_t)(cm * PASOS_POR_CM);
+}
+
 void mover_derecha(float cm)  { 
-	move_axis(0, 1, (uint16_t)(cm * PASOS_POR_CM)); 
+	line_to(pasos(cm), 0); 
 }
 
 void mover_izquierda(float cm){ 
-	move_axis(0, 0, (uint16_t)(cm * PASOS_POR_CM)); 
+	line_to(-pasos(cm), 0); 
 }
 
 void mover_arriba(float cm)   { 
-	move_axis(1, 1, (uint16_t)(cm * PASOS_POR_CM)); 
+	line_to(0, pasos(cm)); 
 }
 
 void mover_abajo(float cm)    { 
-	move_axis(1, 0, (uint16_t)(cm * PASOS_POR_CM)); 
+	line_to(0, -pasos(cm)); 
 }
 
 // -------------------- DIAGONALES --------------------
+// cm en cada eje (con las rectas coordinadas ya no hace falta corregir el largo)
 void mover_diag_arriba_der(float cm) {
-	uint16_t pasos = (uint16_t)(cm * PASOS_POR_CM * DIAG_CORR);
-	for(uint16_t i=0;i<pasos;i++){
-		move_axis(0,1,1); 
-		move_axis(1,1,1); 
-	}
+	line_to(pasos(cm), pasos(cm));
 }
 
 void mover_diag_arriba_izq(float cm) {
-	uint16_t pasos = (uint16_t)(cm * PASOS_POR_CM * DIAG_CORR);
-	for(uint16_t i=0;i<pasos;i++){ 
-		move_axis(0,0,1); 
-		move_axis(1,1,1); 
-	}
+	line_to(-pasos(cm), pasos(cm));
 }
 
 void mover_diag_abajo_der(float cm) {
-	uint16_t pasos = (uint16_t)(cm * PASOS_POR_CM * DIAG_CORR);
-	for(uint16_t i=0;i<pasos;i++){
-		move_axis(0,1,1);
-		move_axis(1,0,1);
-	}
+	line_to(pasos(cm), -pasos(cm));
 }
 
 void mover_diag_abajo_izq(float cm) {
-	uint16_t pasos = (uint16_t)(cm * PASOS_POR_CM * DIAG_CORR);
-	for(uint16_t i=0;i<pasos;i++){
-		move_axis(0,0,1); 
-		move_axis(1,0,1); 
-	}
+	line_to(-pasos(cm), -pasos(cm));
 }
 
 // -------------------- FIGURAS GEOMÉTRICAS --------------------
@@ -157,13 +482,12 @@ void dibujar_cruz(float size){
 	lift_pen();
 }
 
+// Círculo con centro a la izquierda del punto de partida (radio en cm)
 void dibujar_circulo(float radio){
+	int16_t r = pasos(radio);
 	lower_pen();
-	for(int i=0;i<360;i++){
-	mover_diag_arriba_der(0.01745*radio);
-	mover_diag_arriba_izq(0.01745*radio);
-}
-  lift_pen();
+	arco_pasos(r, 0, r, 0, 0, VELOCIDAD);
+	lift_pen();
 }
 
 // -------------------- DIBUJOS --------------------
@@ -386,23 +710,258 @@ void dibujar_rana(void) {
 	lift_pen();
 }
 
+// -------------------- G-CODE POR UART --------------------
+// Una orden por línea, responde "ok" cuando la orden ya está en la cola (o "error: ..."). El host
+// puede esperar cada "ok" o, para no dejar la cola vacía, mandar líneas mientras la suma de las
+// que no tienen respuesta no pase de RX_TAM caracteres (conteo de caracteres, como con grbl).
+//   G0 / G1 X Y F   recta rápida / con avance F (unidades por minuto)
+//   G2 / G3 X Y I J arco horario / antihorario, centro en (I, J) relativo al inicio; sin X Y es
+//                   un círculo completo; con el inicio o el final en el centro responde
+//                   "error: arco invalido"
+//   G20 / G21       pulgadas / milímetros          G90 / G91  absoluto / relativo
+//   M3 / M5         baja / sube el lápiz (también Z: Z <= 0 baja, Z > 0 sube)
+//   M2 / M30        fin: sube el lápiz y espera que termine
+//   M98 P1..P5      dibujos guardados: gato, rana, triángulo, cruz, círculo
+//   ?               posición (mm) y segmentos en la cola
+#define PASOS_POR_MM (PASOS_POR_CM / 10)
+
+volatile char rx_buf[RX_TAM];
+volatile uint8_t rx_cabeza = 0, rx_cola = 0;
+
+ISR(USART_RX_vect) {
+	char c = UDR0;
+	uint8_t sig = (rx_cabeza + 1) & (RX_TAM - 1);
+	if (sig == rx_cola) return;    // Buffer lleno: el host no respetó la ventana
+	rx_buf[rx_cabeza] = c;
+	rx_cabeza = sig;
+}
+
+void UART_init(void) {
+	UBRR0H = (uint8_t)(UBRR_VALUE >> 8);
+	UBRR0L = (uint8_t)UBRR_VALUE;
+	UCSR0A = (1 << U2X0);
+	UCSR0B = (1 << RXEN0) | (1 << TXEN0) | (1 << RXCIE0);
+	UCSR0C = (1 << UCSZ01) | (1 << UCSZ00);
+}
+
+void UART_send_char(char c) {
+	while (!(UCSR0A & (1 << UDRE0)));
+	UDR0 = c;
+}
+
+void UART_send_string(const char *s) {
+	while (*s) UART_send_char(*s++);
+}
+
+// Pasos a "mm.d"
+static void enviar_mm(int32_t pasos) {
+	char num[12];
+	if (pasos < 0) {
+		UART_send_char('-');
+		pasos = -pasos;
+	}
+	ultoa(pasos / PASOS_POR_MM, num, 10);
+	UART_send_string(num);
+	UART_send_char('.');
+	ultoa((pasos % PASOS_POR_MM) * 10 / PASOS_POR_MM, num, 10);
+	UART_send_string(num);
+}
+
+// Junta una línea del buffer de recepción, sin espacios ni comentarios ("(...)" y desde ";").
+// Una línea con solo un comentario también se devuelve (vacía) para que reciba su "ok": el host
+// que espera cada respuesta o cuenta caracteres no se queda esperando. Solo se saltean las líneas
+// sin nada, como el '\n' de un par "\r\n".
+static char linea[LINEA_MAX];
+static uint8_t linea_largo, linea_comentario, linea_larga, linea_algo;
+
+static uint8_t leer_linea(void) {
+	while (rx_cola != rx_cabeza) {
+		char c = rx_buf[rx_cola];
+		rx_cola = (rx_cola + 1) & (RX_TAM - 1);
+		if (c == '\n' || c == '\r') {
+			uint8_t hay = linea_algo || linea_larga;
+			linea[linea_largo] = '\0';
+			linea_largo = linea_comentario = linea_algo = 0;
+			if (hay) return 1;
+			continue;
+		}
+		if (c != ' ' && c != '\t') linea_algo = 1;
+		if (linea_comentario) {
+			if (c == ')' && linea_comentario == '(') linea_comentario = 0;
+			continue;
+		}
+		if (c == '(' || c == ';') {
+			linea_comentario = c;
+			continue;
+		}
+		if (c == ' ' || c == '\t') continue;
+		if (c >= 'a' && c <= 'z') c -= 'a' - 'A';
+		if (linea_largo < LINEA_MAX - 1) linea[linea_largo++] = c;
+		else linea_larga = 1;
+	}
+	return 0;
+}
+
+// Estado modal
+static uint8_t modo_mov = 0;        // 0..3: G0..G3
+static uint8_t relativo = 0;        // G91
+static float escala = PASOS_POR_MM; // Pasos por unidad (G21 mm / G20 pulgadas)
+static uint16_t avance = VELOCIDAD; // Pasos/s de G1..G3
+
+// Recta a un punto absoluto en pasos
+static void ir_a(int32_t x, int32_t y, uint16_t velocidad) {
+	recta((int16_t)(x - pos_x), (int16_t)(y - pos_y), velocidad);
+}
+
+// Arco de la posición actual a (x, y) con centro (cx, cy), en pasos. Devuelve 0 sin moverse si
+// el inicio o el final están en el centro (radio 0 o sin dirección de llegada)
+static uint8_t arco(int32_t x, int32_t y, int32_t cx, int32_t cy, uint8_t horario) {
+	if ((pos_x == cx && pos_y == cy) || (x == cx && y == cy)) return 0;
+	arco_pasos(pos_x - cx, pos_y - cy, x - cx, y - cy, horario, avance);
+	return 1;
+}
+
+static void dibujo_guardado(uint8_t n);
+
+// Número con signo y decimales (strtod leería "0X0" de "G0X0" como hexadecimal)
+static const char *leer_numero(const char *p, float *v) {
+	uint8_t negativo = 0, digitos = 0;
+	if (*p == '-' || *p == '+') negativo = (*p++ == '-');
+	float n = 0, escala_dec = 1;
+	for (; *p >= '0' && *p <= '9'; p++, digitos++) n = n * 10 + (*p - '0');
+	if (*p == '.') {
+		for (p++; *p >= '0' && *p <= '9'; p++, digitos++) {
+			escala_dec *= 0.1;
+			n += (*p - '0') * escala_dec;
+		}
+	}
+	*v = negativo ? -n : n;
+	return digitos ? p : 0;
+}
+
+// Ejecuta una línea; devuelve NULL o el mensaje de error
+static const char *ejecutar_linea(const char *p) {
+	if (linea_larga) {
+		linea_larga = 0;
+		return "linea muy larga";
+	}
+	if (p[0] == '?' && p[1] == '\0') {
+		UART_send_string("<X:");
+		enviar_mm(pos_x);
+		UART_send_string(" Y:");
+		enviar_mm(pos_y);
+		UART_send_string(" cola:");
+		char num[6];
+		utoa((uint8_t)(cola_cabeza - cola_cola) & (COLA_LARGO - 1), num, 10);
+		UART_send_string(num);
+#ifdef PLOTTER_MEDIR_ISR
+		UART_send_string(" isr_us:");
+		utoa(isr_us_max, num, 10);
+		UART_send_string(num);
+#endif
+		UART_send_string(">\r\n");
+		return 0;
+	}
+
+	// Palabras: letra + número
+	float x = 0, y = 0, i = 0, j = 0, z = 0;
+	uint8_t hay_x = 0, hay_y = 0, hay_z = 0, hay_mov = 0, m_cod = 0, dibujo = 0;
+	while (*p) {
+		char letra = *p++;
+		float v;
+		p = leer_numero(p, &v);
+		if (!p) return "falta el numero";
+		switch (letra) {
+			case 'G': {
+				uint8_t g = (uint8_t)v;
+				if (g <= 3) { modo_mov = g; hay_mov = 1; }
+				else if (g == 20) escala = 25.4 * PASOS_POR_MM;
+				else if (g == 21) escala = PASOS_POR_MM;
+				else if (g == 90) relativo = 0;
+				else if (g == 91) relativo = 1;
+				else return "G no soportado";
+				break;
+			}
+			case 'M': {
+				uint8_t mc = (uint8_t)v;
+				if (mc != 2 && mc != 3 && mc != 5 && mc != 30 && mc != 98) return "M no soportado";
+				m_cod = mc;
+				break;
+			}
+			case 'X': x = v; hay_x = 1; break;
+			case 'Y': y = v; hay_y = 1; break;
+			case 'Z': z = v; hay_z = 1; break;
+			case 'I': i = v; break;
+			case 'J': j = v; break;
+			case 'F': {
+				float f = v * escala / 60;   // Unidades/min -> pasos/s
+				if (f < VELOCIDAD_MIN) f = VELOCIDAD_MIN;
+				if (f > VELOCIDAD_G0) f = VELOCIDAD_G0;
+				avance = (uint16_t)f;
+				break;
+			}
+			case 'P': dibujo = (uint8_t)v; break;
+			case 'N': break;   // Número de línea
+			default: return "palabra desconocida";
+		}
+	}
+
+	// Lápiz antes del movimiento
+	if (m_cod == 3 || (hay_z && z <= 0)) lower_pen();
+	if (m_cod == 5 || (hay_z && z > 0)) lift_pen();
+
+	if (hay_x || hay_y || (hay_mov && modo_mov >= 2)) {
+		int32_t tx = pos_x, ty = pos_y;
+		if (hay_x) tx = lround(x * escala) + (relativo ? pos_x : 0);
+		if (hay_y) ty = lround(y * escala) + (relativo ? pos_y : 0);
+		if (modo_mov >= 2) {
+			if (!arco(tx, ty, pos_x + lround(i * escala), pos_y + lround(j * escala), modo_mov == 2))
+				return "arco invalido";
+		} else {
+			ir_a(tx, ty, modo_mov == 0 ? VELOCIDAD_G0 : avance);
+		}
+	}
+
+	if (m_cod == 2 || m_cod == 30) {
+		lift_pen();
+		esperar_cola();
+	}
+	if (m_cod == 98) {
+		if (dibujo < 1 || dibujo > 5) return "dibujo P1..P5";
+		dibujo_guardado(dibujo);
+	}
+	return 0;
+}
+
 // -------------------- MAIN --------------------
+// Los dibujos solo encolan segmentos: el programa sigue leyendo la próxima línea mientras los
+// motores recorren las anteriores.
+static void dibujo_guardado(uint8_t n) {
+	switch (n) {
+		case 1: dibujar_gato(); break;
+		case 2: dibujar_rana(); break;
+		case 3: dibujar_triangulo(5); break;
+		case 4: dibujar_cruz(5); break;
+		default: dibujar_circulo(3); break;
+	}
+	lift_pen();
+}
+
 int main(void){
 	setup_plotter();  // Configurar pines y estado inicial
-    _delay_ms(1000);         // Esperar un segundo antes de comenzar
+	UART_init();
+	UART_send_string("Plotter G-code listo\r\n");
 
 	while(1){
-		dibujar_gato();  
-	  lift_pen();
-	  _delay_ms(2000);
-		dibujar_rana(); 
-		lift_pen(); 
-    _delay_ms(2000);
-		dibujar_triangulo(5); 
-    _delay_ms(2000);
-		dibujar_cruz(5);     
-    _delay_ms(2000);
-		dibujar_circulo(3); 
-    _delay_ms(2000);
+		if (leer_linea()) {
+			const char *error = ejecutar_linea(linea);
+			if (error) {
+				UART_send_string("error: ");
+				UART_send_string(error);
+				UART_send_string("\r\n");
+			} else {
+				UART_send_string("ok\r\n");
+			}
+		}
 	}
 }
@@ -5,6 +5,10 @@
 #include <stdint.h>
 #include "DHT22.h"
 
+// main define la base de tiempo; ac solo se declara
+#define TIEMPO_SOLO_DECLARAR
+#include "tiempo.h"
+
 // --- Configuracin de pines ---
 // Segn tu PDF: "Sensor DHT22" -> "PD2"
 #define DHT_PORT PORTD
@@ -12,30 +16,29 @@
 #define DHT_PIN  PIND
 #define DHT_DATA_PIN PD2 // <-- Corregido al pin PD2
 
+#define DHT_LIMITE_US 200     // Ningn nivel de la respuesta o de un bit dura ms
+#define DHT_UMBRAL_UNO_US 48  // Nivel alto de 26-28 us = 0, de 70 us = 1
+
 void dht22_init(void) {
 	// Lnea en alto por defecto
 	DHT_DDR |= (1 << DHT_DATA_PIN);
 	DHT_PORT |= (1 << DHT_DATA_PIN);
 }
 
-// Funcin interna para leer un bit
-static uint8_t dht_read_bit(uint16_t *timeout_counter) {
-	while (!(DHT_PIN & (1 << DHT_DATA_PIN))) { // Espera inicio de bit (HIGH)
-		_delay_us(1);
-		if (++(*timeout_counter) > 500) return 0; // 500us timeout
-	}
-	_delay_us(30); // Esperar 30us
-	
-	if (DHT_PIN & (1 << DHT_DATA_PIN)) { // Si sigue en HIGH, es un '1'
-		return 1;
-		} else {
-		return 0; // Si baj, es un '0'
+// Espera mientras la lnea siga en 'nivel'; devuelve cuntos us dur (1 como mnimo)
+// o 0 si pas el lmite. Los tiempos salen de micros() (Librerias_Comunes/tiempo.h).
+static uint8_t dht_esperar(uint8_t nivel, uint8_t limite_us) {
+	uint32_t inicio = micros();
+	uint32_t d;
+	while (((DHT_PIN >> DHT_DATA_PIN) & 1) == nivel) {
+		if (micros() - inicio > limite_us) return 0;
 	}
+	d = micros() - inicio;
+	return d ? (uint8_t)d : 1;
 }
 
 bool dht22_read(int16_t *temp_x10, uint16_t *hum_x10) {
 	uint8_t data[5] = {0};
-	uint16_t timeout = 0;
 
 	// --- 1. Seal de inicio (Start) ---
 	DHT_DDR |= (1 << DHT_DATA_PIN);  // Pin como salida
@@ -49,37 +52,19 @@ bool dht22_read(int16_t *temp_x10, uint16_t *hum_x10) {
 	DHT_PORT &= ~(1 << DHT_DATA_PIN); // Desactivar pull-up
 
 	// --- 2. Esperar respuesta del sensor ---
-	timeout = 0;
-	while (DHT_PIN & (1 << DHT_DATA_PIN)) {   // Espera que DHT baje el pin
-		_delay_us(1);
-		if (++timeout > 200) return false; // Falla: Sin respuesta
-	}
-	timeout = 0;
-	while (!(DHT_PIN & (1 << DHT_DATA_PIN))) { // Espera que DHT suba el pin
-		_delay_us(1);
-		if (++timeout > 200) return false; // Falla: Sin respuesta
-	}
-	timeout = 0;
-	while (DHT_PIN & (1 << DHT_DATA_PIN)) {   // Espera que DHT baje el pin (fin de la respuesta)
-		_delay_us(1);
-		if (++timeout > 200) return false; // Falla: Sin respuesta
-	}
+	// El sensor baja la lnea, la deja 80us abajo y 80us arriba
+	if (!dht_esperar(1, DHT_LIMITE_US)) return false; // Falla: Sin respuesta
+	if (!dht_esperar(0, DHT_LIMITE_US)) return false;
+	if (!dht_esperar(1, DHT_LIMITE_US)) return false;
 
 	// --- 3. Leer los 40 bits de datos ---
+	// Cada bit: 50us abajo y un nivel alto cuya duracin da el valor
 	for (uint8_t i = 0; i < 5; i++) { // Para cada uno de los 5 bytes
 		for (uint8_t j = 0; j < 8; j++) { // Para cada uno de los 8 bits
-			timeout = 0;
-			data[i] <<= 1; // Mover bits a la izquierda
-			if (dht_read_bit(&timeout)) {
-				data[i] |= 1;
-			}
-			if (timeout > 0) return false; // Timeout durante la lectura de bits
-			
-			// Esperar a que el pin baje (fin del bit)
-			while(DHT_PIN & (1 << DHT_DATA_PIN)) {
-				_delay_us(1);
-				if(++timeout > 500) return false;
-			}
+			if (!dht_esperar(0, DHT_LIMITE_US)) return false; // Timeout durante la lectura de bits
+			uint8_t alto = dht_esperar(1, DHT_LIMITE_US);
+			if (!alto) return false;
+			data[i] = (data[i] << 1) | (alto > DHT_UMBRAL_UNO_US);
 		}
 	}
 	
@@ -1,11 +1,16 @@
 #include "config.h"
 #include <avr/io.h>
 #include <util/delay.h>
+#include <avr/interrupt.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include "spi.h"
 #include "LCD_4bits.h"
 
+// Base de tiempo compartida (Librerias_Comunes/tiempo.h): Timer0 libre para micros()/millis().
+// Este archivo la define; DHT22.c la usa para medir los pulsos del sensor.
+#include "tiempo.h"
+
 #if SIMULATION_MODE == 0
 #include "DHT22.h"
 #include "MQ135.h"
@@ -39,6 +44,8 @@ int main(void) {
 	lcd_init();
 	SPI_MasterInit();
 	ADC_Init();
+	tiempo_init();
+	sei();
 
 	DDRD &= ~(1 << STOP_BUTTON_PIN);
 	PORTD |= (1 << STOP_BUTTON_PIN);
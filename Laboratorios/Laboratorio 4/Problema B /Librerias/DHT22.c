@@ -5,35 +5,33 @@
 #include <stdint.h>
 #include "DHT22.h"
 
+// main define la base de tiempo; aca solo se declara
+#define TIEMPO_SOLO_DECLARAR
+#include "tiempo.h"
+
 #define DHT_PORT PORTD
 #define DHT_DDR  DDRD
 #define DHT_PIN  PIND
 #define DHT_DATA_PIN PD2
 
+#define DHT_LIMITE_US 200     // Ningun nivel de la respuesta o de un bit dura mas
+#define DHT_UMBRAL_UNO_US 48  // Nivel alto de 26-28 us = 0, de 70 us = 1
+
 void dht22_init(void) {
 	DHT_DDR |= (1 << DHT_DATA_PIN);
 	DHT_PORT |= (1 << DHT_DATA_PIN); // pull-up
 }
 
-static uint8_t dht_read_bit(void) {
-	uint16_t count = 0;
-
-	while (!(DHT_PIN & (1 << DHT_DATA_PIN))) {
-		if (++count > 1000) return 0;
-		_delay_us(1);
-	}
-
-	_delay_us(35); // antes 41
-
-	uint8_t bit = (DHT_PIN & (1 << DHT_DATA_PIN)) ? 1 : 0;
-
-	count = 0;
-	while (DHT_PIN & (1 << DHT_DATA_PIN)) {
-		if (++count > 1000) break;
-		_delay_us(1); // antes 10
+// Espera mientras la linea siga en 'nivel'; devuelve cuantos us duro (1 como minimo)
+// o 0 si paso el limite. Los tiempos salen de micros() (Librerias_Comunes/tiempo.h).
+static uint8_t dht_esperar(uint8_t nivel, uint8_t limite_us) {
+	uint32_t inicio = micros();
+	uint32_t d;
+	while (((DHT_PIN >> DHT_DATA_PIN) & 1) == nivel) {
+		if (micros() - inicio > limite_us) return 0;
 	}
-
-	return bit;
+	d = micros() - inicio;
+	return d ? (uint8_t)d : 1;
 }
 
 bool dht22_read(int16_t *temp_x10, uint16_t *hum_x10) {
@@ -47,17 +45,18 @@ bool dht22_read(int16_t *temp_x10, uint16_t *hum_x10) {
 	DHT_DDR &= ~(1 << DHT_DATA_PIN);
 	DHT_PORT |= (1 << DHT_DATA_PIN);
 
-	uint16_t count = 0;
-	while (DHT_PIN & (1 << DHT_DATA_PIN)) { if (++count > 10000) return false; _delay_us(1); }
-	count = 0;
-	while (!(DHT_PIN & (1 << DHT_DATA_PIN))) { if (++count > 10000) return false; _delay_us(1); }
-	count = 0;
-	while (DHT_PIN & (1 << DHT_DATA_PIN)) { if (++count > 10000) return false; _delay_us(1); }
+	// Respuesta: el sensor baja la linea, la deja 80 us abajo y 80 us arriba
+	if (!dht_esperar(1, DHT_LIMITE_US)) return false;
+	if (!dht_esperar(0, DHT_LIMITE_US)) return false;
+	if (!dht_esperar(1, DHT_LIMITE_US)) return false;
 
+	// Cada bit: 50 us abajo y un nivel alto cuya duracion da el valor
 	for (uint8_t i = 0; i < 5; i++) {
 		for (uint8_t j = 0; j < 8; j++) {
-			data[i] <<= 1;
-			data[i] |= dht_read_bit();
+			if (!dht_esperar(0, DHT_LIMITE_US)) return false;
+			uint8_t alto = dht_esperar(1, DHT_LIMITE_US);
+			if (!alto) return false;
+			data[i] = (data[i] << 1) | (alto > DHT_UMBRAL_UNO_US);
 		}
 	}
 
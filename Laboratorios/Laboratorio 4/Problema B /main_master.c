@@ -1,6 +1,7 @@
 #include "config.h"
 #include <avr/io.h>
 #include <util/delay.h>
+#include <avr/interrupt.h>
 #include <stdbool.h>
 #include <stdio.h>
 
@@ -9,6 +10,10 @@
 #include "uart.h" 
 
 
+// Base de tiempo compartida (Librerias_Comunes/tiempo.h): Timer0 libre para micros()/millis().
+// Este archivo la define; DHT22.c la usa para medir los pulsos del sensor.
+#include "tiempo.h"
+
 #if SIMULATION_MODE == 0
 #include "DHT22.h"
 #include "MQ135.h"
@@ -44,6 +49,8 @@ int main(void) {
 	TWI_MasterInit();   
 	ADC_Init();
 	uart_init(9600);   
+	tiempo_init();
+	sei();
 
 
 	DDRD &= ~(1 << STOP_BUTTON_PIN);
@@ -3,7 +3,27 @@
 #include <avr/interrupt.h>
 #include <avr/pgmspace.h>
 #include <stdint.h>
+#include <stdlib.h>
 #include <util/delay.h>
+#include <util/atomic.h>
+#include <util/crc16.h>
+#include <string.h>
+#include <stddef.h>
+
+// Geometría de la matriz (Librerias_Comunes/matriz.h)
+#define MATRIZ_ANCHO 16
+#define MATRIZ_ALTO 16
+#define MATRIZ_SERPENTINA 1 // Filas impares cableadas de derecha a izquierda
+#include "matriz.h"
+#include "transicion.h"
+
+// Etapa de salida (Librerias_Comunes/ws2812_salida.h)
+#define SALIDA_NUM_LEDS 256
+#define SALIDA_LIMITE_MA 2000  // Fuente de 5 V / 2 A
+#define SALIDA_DITHER 1
+#include "ws2812_salida.h"
+#define REFRESCO_MS 20         // Reenvío del frame visible para el dithering temporal
+#define PASO_BRILLO 16
 
 #define NUM_LEDS 256   // Cantidad de LEDs WS2812
 #define DATA_PIN PD6 // Pin de datos para los LEDs
@@ -17,9 +37,12 @@ typedef struct {
 	uint8_t r,g,b; 
 	} Color;
 
-// Arreglo principal de LEDs
+// Arreglo principal de LEDs (en orden de cableado)
 Color leds[NUM_LEDS];
 
+// Sprites y texto desplazable dibujados en leds (Librerias_Comunes/sprites.h)
+#include "sprites.h"
+
 // Frames 
 const uint8_t frame1[NUM_LEDS] PROGMEM = { 
 	#include "frame1.txt" 
@@ -82,6 +105,10 @@ void UART_print_P(const char *s){
 	char c;while((c=pgm_read_byte(s++))) UART_send(c);
 	}
 	
+void UART_print_num(uint32_t n){
+	char buf[11]; ultoa(n, buf, 10); UART_print(buf);
+	}
+	
 char UART_check_receive(){
 	if(UCSR0A&(1<<RXC0)) 
 	return UDR0; 
@@ -95,102 +122,572 @@ void UART_init(){
 	UCSR0C=(1<<UCSZ01)|(1<<UCSZ00);
 	}
 
-// Retardo
-void delay_variable_ms(uint16_t ms) {
-	for (uint16_t i = 0; i < ms; i++) {
-		_delay_ms(1);
+// WS2812
+// Envía un byte MSB primero (inline para no agregar llamadas entre bits)
+static inline __attribute__((always_inline)) void ws2812_byte(uint8_t v){
+	uint8_t mask=0x80;
+	while(mask){
+		if(v&mask){
+			PORTD|=(1<<DATA_PIN);
+			__asm__ __volatile__("nop\nnop\nnop\nnop\nnop\nnop\nnop\nnop\nnop\nnop\nnop\n");
+			PORTD&=~(1<<DATA_PIN);
+			__asm__ __volatile__("nop\nnop\nnop\nnop\nnop\n");
+			}else{
+			PORTD|=(1<<DATA_PIN);
+			__asm__ __volatile__("nop\nnop\nnop\n");
+			PORTD&=~(1<<DATA_PIN);
+			__asm__ __volatile__("nop\nnop\nnop\nnop\nnop\nnop\nnop\nnop\nnop\n");
+		}
+		mask>>=1;
 	}
 }
 
-// WS2812
+// Todos los envíos pasan cada byte por salida_canal() (gamma, brillo, dither) dentro del mismo
+// bucle; el cálculo cae entre bytes, con la línea en bajo, y no altera el tiempo de los bits.
 void ws2812_send(Color *leds,uint16_t n){
 	cli(); // deshabilita interrupciones
 	for(uint16_t i=0;i<n;i++){
-		uint8_t colors[3]={leds[i].g,leds[i].r,leds[i].b};
-		for(uint8_t k=0;k<3;k++){
-			uint8_t mask=0x80;
-			while(mask){
-				if(colors[k]&mask){
-					PORTD|=(1<<DATA_PIN);
-					__asm__ __volatile__("nop\nnop\nnop\nnop\nnop\nnop\nnop\nnop\nnop\nnop\nnop\n");
-					PORTD&=~(1<<DATA_PIN);
-					__asm__ __volatile__("nop\nnop\nnop\nnop\nnop\n");
-					}else{
-					PORTD|=(1<<DATA_PIN);
-					__asm__ __volatile__("nop\nnop\nnop\n");
-					PORTD&=~(1<<DATA_PIN);
-					__asm__ __volatile__("nop\nnop\nnop\nnop\nnop\nnop\nnop\nnop\nnop\n");
-				}
-				mask>>=1;
-			}
-		}
+		ws2812_byte(salida_canal(leds[i].g));
+		ws2812_byte(salida_canal(leds[i].r));
+		ws2812_byte(salida_canal(leds[i].b));
 	}
 	sei(); // habilita interrupciones
+	salida_fin_frame();
 	for(volatile uint16_t i=0;i<50;i++);  // retardo final
 }
 
-// Convierte índice lineal a "serpentine"
-uint16_t unmapSerpentine(uint16_t i) {
-	if (i >= NUM_LEDS) return 0;
+// Envía bytes ya ordenados G-R-B (los frames recibidos por streaming)
+void ws2812_send_crudo(const uint8_t *datos,uint16_t n_bytes){
+	cli();
+	for(uint16_t i=0;i<n_bytes;i++){
+		ws2812_byte(salida_canal(datos[i]));
+	}
+	sei();
+	salida_fin_frame();
+	for(volatile uint16_t i=0;i<50;i++);
+}
 
-	uint8_t fila = i / MATRIZ_TAMANIO;
-	uint8_t columna = i % MATRIZ_TAMANIO;
-	uint16_t indice_logico;
+// Paleta de los frames (a cada variable/numero se le asigna un color)
+const Color paleta_frames[16] PROGMEM = {
+	{0, 0, 0},       // 0
+	{253, 30, 0},    // 1
+	{128, 64, 0},    // 2
+	{255, 200, 255}, // 3
+	{128, 0, 32},    // 4
+	{0, 0, 0},       // 5 (sin usar)
+	{0, 0, 255},     // 6
+	{0, 150, 255},   // 7
+	{253, 166, 0},   // 8
+	{128, 64, 0},    // 9
+	{255, 0, 0},     // 10
+	{0, 255, 0},     // 11
+	{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}
+};
 
-	if (fila % 2 != 0) {
-		columna = (MATRIZ_TAMANIO - 1) - columna;
+// Mostrar Frame: decodifica desde PROGMEM mientras transmite, sin pasar por el buffer de LEDs
+void mostrarFrameColor(const uint8_t *frame){
+	cli();
+	// Recorre la matriz en orden de cableado: cada fila es un puntero con paso +1 o -1
+	for(uint8_t fila=0;fila<MATRIZ_FIS_ALTO;fila++){
+		const uint8_t *p = frame + matriz_inicio_fila(fila);
+		int8_t paso = matriz_paso_fila(fila);
+		for(uint8_t col=0;col<MATRIZ_FIS_ANCHO;col++,p+=paso){
+			const Color *c = &paleta_frames[pgm_read_byte(p) & 0x0F];
+			ws2812_byte(salida_canal(pgm_read_byte(&c->g)));
+			ws2812_byte(salida_canal(pgm_read_byte(&c->r)));
+			ws2812_byte(salida_canal(pgm_read_byte(&c->b)));
+		}
 	}
-	
-	indice_logico = (fila * MATRIZ_TAMANIO) + columna;
+	sei();
+	salida_fin_frame();
+	for(volatile uint16_t i=0;i<50;i++);
+}
 
-	return indice_logico;
+// TRANSICIONES ENTRE FRAMES (Librerias_Comunes/transicion.h)
+// Durante la transición cada pixel se calcula al transmitir: se leen de PROGMEM el pixel del frame
+// saliente y el del entrante, y se mezcla canal por canal justo antes de enviar ese byte, así el
+// tiempo entre bytes (con la línea en bajo) queda en unos pocos microsegundos.
+#define TRANSICION_MS 120
+Transicion trans = {TRANS_FUNDIDO, 0};
+
+// Canal (offset dentro de Color) mezclado entre dos colores de la paleta
+static inline __attribute__((always_inline)) uint8_t canal_mezcla(const Color *a, const Color *b, uint8_t off, uint8_t peso){
+	return mezcla8(pgm_read_byte((const uint8_t*)a + off), pgm_read_byte((const uint8_t*)b + off), peso);
 }
 
-// Mostrar Frame (a cada variable/numero se le asigna un color)
-void mostrarFrameColor(const uint8_t *frame){
-	uint16_t indice_logico;
-	for(uint16_t i=0;i<NUM_LEDS;i++){
-		indice_logico = unmapSerpentine(i);
-		uint8_t val=pgm_read_byte(&(frame[indice_logico]));
-		
-		switch(val){
-			case 0: leds[i].r=0; leds[i].g=0; leds[i].b=0; break;
-			case 2: leds[i].r=128; leds[i].g=64; leds[i].b=0; break;
-			case 1: leds[i].r=253; leds[i].g=30; leds[i].b=0; break;
-			case 3: leds[i].r=255; leds[i].g=200; leds[i].b=255; break;
-			case 4: leds[i].r=128; leds[i].g=0; leds[i].b=32; break;
-			case 10: leds[i].r=255; leds[i].g=0; leds[i].b=0; break;
-			case 6: leds[i].r=0; leds[i].g=0; leds[i].b=255; break;
-			case 7: leds[i].r=0; leds[i].g=150; leds[i].b=255; break;
-			case 8: leds[i].r=253; leds[i].g=166; leds[i].b=0; break;
-			case 9: leds[i].r=128; leds[i].g=64; leds[i].b=0; break;
-			case 11: leds[i].r=0; leds[i].g=255; leds[i].b=0; break;
+void mostrarTransicion(const uint8_t *sal, const uint8_t *ent){
+	cli();
+	for(uint8_t fila=0;fila<MATRIZ_FIS_ALTO;fila++){
+		uint16_t l = matriz_inicio_fila(fila); // Índice lógico del pixel (y * ancho + x)
+		int8_t paso = matriz_paso_fila(fila);
+		for(uint8_t col=0;col<MATRIZ_FIS_ANCHO;col++,l+=paso){
+			uint16_t base = l - l % MATRIZ_ANCHO;
+			MuestraTransicion m = transicion_pixel(&trans, l % MATRIZ_ANCHO);
+			const Color *a = &paleta_frames[pgm_read_byte(sal + base + m.x_sal) & 0x0F];
+			const Color *b = &paleta_frames[pgm_read_byte(ent + base + m.x_ent) & 0x0F];
+			ws2812_byte(salida_canal(canal_mezcla(a, b, offsetof(Color, g), m.peso)));
+			ws2812_byte(salida_canal(canal_mezcla(a, b, offsetof(Color, r), m.peso)));
+			ws2812_byte(salida_canal(canal_mezcla(a, b, offsetof(Color, b), m.peso)));
 		}
 	}
-	ws2812_send(leds, NUM_LEDS);
+	sei();
+	salida_fin_frame();
+	for(volatile uint16_t i=0;i<50;i++);
 }
 
 // Mostrar color uniforme
 void mostrarColor(uint8_t r, uint8_t g, uint8_t b){
+	cli();
 	for(uint16_t i=0;i<NUM_LEDS;i++){
-		leds[i].r=r; leds[i].g=g; leds[i].b=b;
+		ws2812_byte(salida_canal(g));
+		ws2812_byte(salida_canal(r));
+		ws2812_byte(salida_canal(b));
 	}
-	ws2812_send(leds, NUM_LEDS);
+	sei();
+	salida_fin_frame();
+	for(volatile uint16_t i=0;i<50;i++);
+}
+
+// SECUENCIADOR DE ANIMACIONES
+// Timer1 cuenta libre con prescaler 1024 (64 us por tick, vuelta cada ~4,2 s). La hora de cada
+// frame se programa en OCR1A sumando la duración al vencimiento anterior, no a "ahora", así el
+// tiempo que se pasa en ws2812_send() (con interrupciones apagadas) o decodificando no se acumula.
+// El paso siguiente se lee de PROGMEM apenas se muestra el actual; como el frame se decodifica
+// durante el envío, al vencer solo queda transmitir.
+#define US_POR_TICK 64
+#define MS_A_TICKS(ms) ((uint16_t)(((uint32_t)(ms) * 1000UL) / US_POR_TICK))
+
+// Paso de animación: frame en PROGMEM y cuánto tiempo se muestra
+typedef struct {
+	const uint8_t *frame;
+	uint16_t duracion; // ticks de Timer1
+} PasoAnimacion;
+
+// Paso de la inicialización: color uniforme y duración
+typedef struct {
+	uint8_t r, g, b;
+	uint16_t duracion; // ticks de Timer1
+} PasoColor;
+
+// Secuencias de animaciones (frame, tiempo de cada frame)
+const PasoAnimacion secuencia_perrito[] PROGMEM = {
+	{frame1, MS_A_TICKS(200)}, {frame2, MS_A_TICKS(200)}, {frame1, MS_A_TICKS(200)}, {frame2, MS_A_TICKS(200)},
+	{frame1, MS_A_TICKS(200)}, {frame2, MS_A_TICKS(200)}, {frame1, MS_A_TICKS(200)}, {frame2, MS_A_TICKS(200)},
+	{frame3, MS_A_TICKS(400)}, {frame2, MS_A_TICKS(400)}, {frame3, MS_A_TICKS(400)}, {frame2, MS_A_TICKS(400)},
+	{frame3, MS_A_TICKS(400)}, {frame4, MS_A_TICKS(400)}, {frame5, MS_A_TICKS(400)}, {frame4, MS_A_TICKS(400)},
+	{frame5, MS_A_TICKS(400)}, {frame4, MS_A_TICKS(400)}, {frame4, MS_A_TICKS(400)}, {frame5, MS_A_TICKS(400)},
+	{frame4, MS_A_TICKS(400)}, {frame3, MS_A_TICKS(400)}, {frame2, MS_A_TICKS(400)}, {frame6, MS_A_TICKS(800)}
+};
+
+const PasoAnimacion secuencia_fantasma[] PROGMEM = {
+	{frameA, MS_A_TICKS(250)}, {frameB, MS_A_TICKS(250)}, {frameC, MS_A_TICKS(250)}, {frameD, MS_A_TICKS(250)},
+	{frameE, MS_A_TICKS(250)}, {frameF, MS_A_TICKS(250)}, {frameE, MS_A_TICKS(250)}, {frameD, MS_A_TICKS(250)}
+};
+
+const PasoColor secuencia_init[NUM_COLORES_INICIALIZACION] PROGMEM = {
+	{255, 0, 0, MS_A_TICKS(500)},     // Rojo
+	{0, 255, 0, MS_A_TICKS(500)},     // Verde
+	{0, 0, 255, MS_A_TICKS(500)},     // Azul
+	{255, 255, 255, MS_A_TICKS(500)}, // Blanco
+	{0, 0, 0, MS_A_TICKS(300)}        // Apagado
+};
+
+#define LARGO_PERRITO  (sizeof(secuencia_perrito)/sizeof(secuencia_perrito[0]))
+#define LARGO_FANTASMA (sizeof(secuencia_fantasma)/sizeof(secuencia_fantasma[0]))
+
+volatile uint8_t frame_vencido = 0;      // Lo marca el Timer1 cuando llega la hora del frame preparado
+volatile uint16_t hora_frame;            // Valor de TCNT1 en que vencía ese frame
+volatile uint16_t duracion_preparada;    // Duración del paso preparado
+volatile uint8_t frames_perdidos = 0;    // Vencimientos que llegaron con el anterior sin mostrar
+
+uint8_t modo = 0;           // 1 = Perrito, 2 = Fantasma, 3 = Inicialización, 4 = Texto, 0 = ninguno
+uint8_t paso_idx = 0;       // Índice del paso preparado
+uint8_t reproduciendo = 0;
+
+// Paso listo para mostrar: frame en PROGMEM, el buffer leds ya dibujado o, si no, color uniforme
+typedef struct {
+	const uint8_t *frame;
+	uint8_t r, g, b;
+	uint8_t buffer;
+} Paso;
+
+Paso paso_listo;            // Siguiente paso (ya leído de PROGMEM)
+Paso paso_visible;          // Lo que está en la matriz, para refrescarlo
+uint8_t hay_visible = 0;
+uint16_t ultimo_envio = 0;  // TCNT1 del último envío a la matriz
+const uint8_t *frame_saliente = NULL; // Frame anterior mientras dura una transición
+uint16_t inicio_transicion;           // TCNT1 en que empezó
+
+// Estadísticas de jitter (latencia entre la hora programada y el inicio del envío)
+uint16_t lat_min = 0xFFFF, lat_max = 0;
+uint32_t lat_suma = 0;
+uint16_t lat_cuenta = 0;
+
+ISR(TIMER1_COMPA_vect){
+	if(frame_vencido) frames_perdidos++;
+	hora_frame = OCR1A;
+	OCR1A += duracion_preparada; // Próximo vencimiento relativo al anterior: sin deriva
+	frame_vencido = 1;
+}
+
+void timer1_init(){
+	TCCR1A = 0;                           // Modo normal, cuenta libre
+	TCCR1B = (1<<CS12)|(1<<CS10);         // Prescaler 1024 -> 64 us por tick
 }
 
-uint8_t init_colores[NUM_COLORES_INICIALIZACION][3] = {
-	{255, 0, 0},     // Rojo
-	{0, 255, 0},     // Verde
-	{0, 0, 255},     // Azul
-	{255, 255, 255}, // Blanco
-	{0, 0, 0}        // Apagado
+// TEXTO DESPLAZABLE
+// "HOLA MUNDO" corre por la mitad inferior a 60 fps y un corazón con contorno (máscara) cruza la
+// mitad superior entrando y saliendo por los bordes. Cada frame se dibuja en leds apenas se
+// envía el anterior, igual que los pasos de las animaciones.
+#define TEXTO_PERIODO ((uint16_t)(1000000UL / 60 / US_POR_TICK)) // 260 ticks = 16,6 ms
+#define TEXTO_VELOCIDAD 8     // 1/16 de columna por frame: 30 columnas por segundo
+#define CORAZON_VELOCIDAD 4   // 1/16 de pixel por frame
+#define CORAZON_ANCHO 9
+
+const char texto_hola[] PROGMEM = "HOLA MUNDO";
+
+const uint8_t sprite_corazon[] PROGMEM = {
+	CORAZON_ANCHO, 8, SPRITE_MASCARA,
+	// Imagen
+	0x00,0x00, 0x36,0x00, 0x7F,0x00, 0x7F,0x00, 0x3E,0x00, 0x1C,0x00, 0x08,0x00, 0x00,0x00,
+	// Máscara: la imagen con un pixel de contorno
+	0x7F,0x00, 0xFF,0x80, 0xFF,0x80, 0xFF,0x80, 0xFF,0x80, 0x7F,0x00, 0x3E,0x00, 0x1C,0x00
 };
 
-uint16_t init_tiempos[NUM_COLORES_INICIALIZACION] = {500, 500, 500, 500, 300}; // ms
+const Color color_texto = {255, 160, 0};
+const Color color_negro = {0, 0, 0};
+const Color color_corazon = {255, 0, 40};
+const Color color_contorno = {40, 40, 60};
+
+Scroll scroll;
+int16_t corazon_pos;        // Posición x del corazón en 1/16 de pixel
+uint16_t dibujo_max = 0;    // Peor tiempo de dibujo (ticks de Timer1)
+
+void iniciar_texto(){
+	scroll_iniciar(&scroll, texto_hola, TEXTO_VELOCIDAD);
+	corazon_pos = -CORAZON_ANCHO * 16;
+}
+
+void dibujar_texto(){
+	uint16_t t0 = TCNT1;
+	memset(leds, 0, sizeof(leds));
+	scroll_avanzar(&scroll);
+	scroll_dibujar(leds, &scroll, 8, color_texto, color_negro);
+	corazon_pos += CORAZON_VELOCIDAD;
+	if(corazon_pos >= MATRIZ_ANCHO * 16) corazon_pos = -CORAZON_ANCHO * 16;
+	sprite_dibujar(leds, sprite_corazon, corazon_pos >> 4, 0, color_corazon, color_contorno);
+	uint16_t dt = TCNT1 - t0;
+	if(dt > dibujo_max) dibujo_max = dt;
+}
+
+uint8_t largo_modo(uint8_t m){
+	if(m==1) return LARGO_PERRITO;
+	if(m==2) return LARGO_FANTASMA;
+	if(m==4) return 1;
+	return NUM_COLORES_INICIALIZACION;
+}
+
+// Lee de PROGMEM el paso paso_idx mientras el anterior está en la matriz
+void preparar_paso(){
+	uint16_t duracion;
+	paso_listo.buffer = 0;
+	if(modo==4){
+		dibujar_texto();
+		paso_listo.buffer = 1;
+		duracion = TEXTO_PERIODO;
+	}else if(modo==3){
+		PasoColor c;
+		memcpy_P(&c, &secuencia_init[paso_idx], sizeof(c));
+		paso_listo.frame = NULL;
+		paso_listo.r = c.r; paso_listo.g = c.g; paso_listo.b = c.b;
+		duracion = c.duracion;
+	}else{
+		PasoAnimacion p;
+		memcpy_P(&p, (modo==1) ? &secuencia_perrito[paso_idx] : &secuencia_fantasma[paso_idx], sizeof(p));
+		paso_listo.frame = p.frame;
+		duracion = p.duracion;
+	}
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE){ duracion_preparada = duracion; }
+}
+
+void mostrar_paso(const Paso *p){
+	if(p->buffer) ws2812_send(leds, NUM_LEDS);
+	else if(p->frame) mostrarFrameColor(p->frame);
+	else mostrarColor(p->r, p->g, p->b);
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE){ ultimo_envio = TCNT1; }
+	hay_visible = 1;
+}
+
+// Arranca (o reanuda) la secuencia: el paso siguiente ya está preparado
+void reanudar(){
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE){
+		OCR1A = TCNT1 + 2;        // Primer frame casi inmediato
+		TIFR1 = (1<<OCF1A);
+		frame_vencido = 0;
+		TIMSK1 |= (1<<OCIE1A);
+	}
+	reproduciendo = 1;
+}
+
+void detener(){
+	TIMSK1 &= ~(1<<OCIE1A);
+	frame_vencido = 0;
+	reproduciendo = 0;
+}
+
+void iniciar_modo(uint8_t m){
+	detener();
+	modo = m;
+	paso_idx = 0;
+	if(m==4) iniciar_texto();
+	preparar_paso();
+	reanudar();
+}
+
+void registrar_latencia(uint16_t lat){
+	if(lat<lat_min) lat_min=lat;
+	if(lat>lat_max) lat_max=lat;
+	lat_suma += lat;
+	lat_cuenta++;
+}
+
+void reportar_jitter(){
+	UART_print_P(PSTR("\nFrames: ")); UART_print_num(lat_cuenta);
+	if(lat_cuenta){
+		UART_print_P(PSTR("  Latencia min/prom/max (us): "));
+		UART_print_num((uint32_t)lat_min*US_POR_TICK); UART_send('/');
+		UART_print_num(lat_suma*US_POR_TICK/lat_cuenta); UART_send('/');
+		UART_print_num((uint32_t)lat_max*US_POR_TICK);
+		UART_print_P(PSTR("  Jitter (us): "));
+		UART_print_num((uint32_t)(lat_max-lat_min)*US_POR_TICK);
+	}
+	UART_print_P(PSTR("  Perdidos: ")); UART_print_num(frames_perdidos);
+	if(modo==4){
+		UART_print_P(PSTR("  Dibujo max (us): ")); UART_print_num((uint32_t)dibujo_max*US_POR_TICK);
+	}
+	UART_send('\n');
+	lat_min=0xFFFF; lat_max=0; lat_suma=0; lat_cuenta=0; frames_perdidos=0; dibujo_max=0;
+}
+
+// STREAMING DE FRAMES POR UART
+// El host (Host/enviar_frames.cpp) manda frames completos a alta velocidad con U2X:
+//   0xA5 0x5A | tipo | largo (LSB, MSB) | datos | CRC16-XMODEM (LSB, MSB) sobre tipo..datos
+//   tipo 0x00 ping (sin datos), 0x01 crudo (768 bytes G-R-B en orden de cableado),
+//   0x02 paleta (n, n*3 bytes G-R-B, 128 bytes con 2 índices de 4 bits por byte), 0x03 salir
+// El ISR de RX escribe directamente en el buffer de LEDs (el "back buffer": lo que se ve está
+// latcheado en la matriz). Al completar un frame con CRC válido el main lo envía a la matriz
+// (vsync) y recién entonces responde ACK; el host no manda el siguiente frame hasta recibirlo,
+// así nunca llegan bytes mientras ws2812_send tiene las interrupciones apagadas.
+#define STREAM_SYNC1   0xA5
+#define STREAM_SYNC2   0x5A
+#define STREAM_PING    0x00
+#define STREAM_CRUDO   0x01
+#define STREAM_PALETA  0x02
+#define STREAM_SALIR   0x03
+#define STREAM_ACK     0x06
+#define STREAM_NAK     0x15
+#define STREAM_MAX_COLORES 16
+#define STREAM_BYTES_CRUDO   (NUM_LEDS*3)
+#define STREAM_BYTES_INDICES (NUM_LEDS/2)
+
+enum { RX_SYNC1, RX_SYNC2, RX_TIPO, RX_LEN_L, RX_LEN_H, RX_DATOS, RX_CRC_L, RX_CRC_H };
+enum { FRAME_NINGUNO, FRAME_OK, FRAME_ERROR };
+
+volatile uint8_t rx_estado = RX_SYNC1;
+volatile uint8_t rx_listo = FRAME_NINGUNO;  // Resultado del último frame completo
+volatile uint8_t rx_actividad = 0;          // Llegó algún byte desde la última revisión
+volatile uint8_t rx_tipo;
+volatile uint16_t rx_largo;
+uint16_t rx_cuenta, rx_crc;                 // Solo los usa el ISR
+uint8_t rx_crc_bajo;
+uint8_t *rx_ptr;
+
+// Largo válido de datos para cada tipo de frame
+static uint8_t largo_valido(uint8_t tipo, uint16_t largo){
+	if(tipo==STREAM_CRUDO) return largo==STREAM_BYTES_CRUDO;
+	if(tipo==STREAM_PALETA) return largo>=1+3+STREAM_BYTES_INDICES && largo<=1+3*STREAM_MAX_COLORES+STREAM_BYTES_INDICES;
+	return largo==0;
+}
+
+// Un frame con paleta debe traer exactamente n colores (1..16) y los índices: con otro n el
+// memcpy de la paleta pasaría su arreglo o los índices se leerían fuera del buffer. El CRC no
+// alcanza (un host con errores lo calcula bien sobre un frame mal armado).
+static uint8_t paleta_valida(uint8_t n, uint16_t largo){
+	return n>=1 && n<=STREAM_MAX_COLORES && largo==1+3*(uint16_t)n+STREAM_BYTES_INDICES;
+}
+
+ISR(USART_RX_vect){
+	uint8_t err = UCSR0A & ((1<<FE0)|(1<<DOR0));
+	uint8_t b = UDR0;
+	rx_actividad = 1;
+	if(err){ rx_estado = RX_SYNC1; rx_listo = FRAME_ERROR; return; }
+
+	switch(rx_estado){
+		case RX_SYNC1:
+			if(b==STREAM_SYNC1) rx_estado = RX_SYNC2;
+			break;
+		case RX_SYNC2:
+			rx_estado = (b==STREAM_SYNC2) ? RX_TIPO : RX_SYNC1;
+			break;
+		case RX_TIPO:
+			rx_tipo = b; rx_crc = _crc_xmodem_update(0, b);
+			rx_estado = RX_LEN_L;
+			break;
+		case RX_LEN_L:
+			rx_largo = b; rx_crc = _crc_xmodem_update(rx_crc, b);
+			rx_estado = RX_LEN_H;
+			break;
+		case RX_LEN_H:
+			rx_largo |= (uint16_t)b<<8; rx_crc = _crc_xmodem_update(rx_crc, b);
+			if(!largo_valido(rx_tipo, rx_largo)){ rx_estado = RX_SYNC1; rx_listo = FRAME_ERROR; break; }
+			// Los frames con paleta se guardan al final del buffer para decodificarlos en el lugar
+			rx_ptr = (uint8_t*)leds + ((rx_tipo==STREAM_PALETA) ? sizeof(leds)-rx_largo : 0);
+			rx_cuenta = rx_largo;
+			rx_estado = rx_cuenta ? RX_DATOS : RX_CRC_L;
+			break;
+		case RX_DATOS:
+			if(rx_tipo==STREAM_PALETA && rx_cuenta==rx_largo && !paleta_valida(b, rx_largo)){
+				rx_estado = RX_SYNC1; rx_listo = FRAME_ERROR; // NAK y se descarta
+				break;
+			}
+			*rx_ptr++ = b; rx_crc = _crc_xmodem_update(rx_crc, b);
+			if(--rx_cuenta==0) rx_estado = RX_CRC_L;
+			break;
+		case RX_CRC_L:
+			rx_crc_bajo = b;
+			rx_estado = RX_CRC_H;
+			break;
+		case RX_CRC_H:
+			rx_listo = ((((uint16_t)b<<8)|rx_crc_bajo)==rx_crc) ? FRAME_OK : FRAME_ERROR;
+			rx_estado = RX_SYNC1;
+			break;
+	}
+}
+
+// Expande un frame con paleta (guardado al final del buffer) a G-R-B, en el mismo buffer.
+// Cada par de pixeles lee su byte de índices antes de escribir; la escritura nunca alcanza
+// índices que falten leer.
+void decodificar_paleta(uint16_t largo){
+	uint8_t *dst = (uint8_t*)leds;
+	const uint8_t *src = dst + sizeof(leds) - largo;
+	uint8_t pal[STREAM_MAX_COLORES*3] = {0};
+	uint8_t n = *src++;
+	memcpy(pal, src, n*3);
+	src += n*3;
+	for(uint8_t j=0;j<STREAM_BYTES_INDICES;j++){
+		uint8_t par = *src++;
+		const uint8_t *c = &pal[(par>>4)*3];
+		dst[0]=c[0]; dst[1]=c[1]; dst[2]=c[2];
+		c = &pal[(par&0x0F)*3];
+		dst[3]=c[0]; dst[4]=c[1]; dst[5]=c[2];
+		dst += 6;
+	}
+}
+
+// UBRR con U2X (F_CPU/8/baud - 1): 115200 -> 16, 500000 -> 3, 1000000 -> 1; 0 = selector inválido
+uint8_t ubrr_streaming(char sel){
+	if(sel=='1') return 16;
+	if(sel=='2') return 3;
+	if(sel=='3') return 1;
+	return 0;
+}
+
+void modo_streaming(char sel){
+	uint8_t ubrr = ubrr_streaming(sel);
+	if(!ubrr){ // Cualquier otra tecla deja la velocidad como está
+		UART_print_P(PSTR("\nVelocidad invalida: usar T1, T2 o T3\n"));
+		return;
+	}
+	detener();
+	modo = 0;
+	hay_visible = 0; // La matriz pasa a mostrar lo que manda el host
+	frame_saliente = NULL;
+	UART_print_P(PSTR("\nStreaming de frames (ver Host/enviar_frames.cpp). Frame tipo 3 para salir.\n"));
+	_delay_ms(20); // Terminar de transmitir el mensaje antes de cambiar la velocidad
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE){
+		UBRR0H = 0; UBRR0L = ubrr;
+		UCSR0A = (1<<U2X0);
+		while(UCSR0A & (1<<RXC0)) (void)UDR0;
+		rx_estado = RX_SYNC1; rx_listo = FRAME_NINGUNO;
+		UCSR0B |= (1<<RXCIE0);
+	}
+
+	uint16_t ultima_actividad = TCNT1;
+	uint8_t salir = 0;
+	while(!salir){
+		uint8_t r = rx_listo;
+		if(r!=FRAME_NINGUNO){
+			rx_listo = FRAME_NINGUNO;
+			if(r==FRAME_OK){
+				if(rx_tipo==STREAM_CRUDO) ws2812_send_crudo((uint8_t*)leds, STREAM_BYTES_CRUDO);
+				else if(rx_tipo==STREAM_PALETA){
+					decodificar_paleta(rx_largo);
+					ws2812_send_crudo((uint8_t*)leds, STREAM_BYTES_CRUDO);
+				}
+				else if(rx_tipo==STREAM_SALIR) salir = 1;
+				UART_send(STREAM_ACK); // Listo para el siguiente frame
+			}else{
+				UART_send(STREAM_NAK);
+			}
+		}
+		// Frame a medias sin bytes por 100 ms: el host se cortó, volver a esperar sincronismo
+		if(rx_actividad){
+			rx_actividad = 0;
+			ultima_actividad = TCNT1;
+		}else if(rx_estado!=RX_SYNC1 && (uint16_t)(TCNT1-ultima_actividad) > MS_A_TICKS(100)){
+			rx_estado = RX_SYNC1;
+		}
+	}
+
+	_delay_ms(2); // Que salga el ACK antes de volver a 9600
+	UCSR0B &= ~(1<<RXCIE0);
+	UCSR0A = 0;
+	UART_init();
+	UART_print_P(PSTR("\nFin del streaming\n"));
+}
+
+void reportar_salida(){
+	UART_print_P(PSTR("\nBrillo: ")); UART_print_num(salida_brillo);
+	UART_print_P(PSTR("  Efectivo: ")); UART_print_num(salida_escala);
+	UART_print_P(PSTR("  Corriente estimada (mA): ")); UART_print_num(salida_ma);
+	UART_print_P(PSTR("  Limite (mA): ")); UART_print_num(SALIDA_LIMITE_MA);
+	UART_send('\n');
+}
+
+// Costo de la mezcla sola (sin salida_canal ni transmisión) para n pixeles, en microsegundos.
+// Se repite 16 veces para que la resolución de 64 us del Timer1 no domine.
+uint32_t medir_mezcla(uint16_t n){
+	volatile uint8_t sumidero;
+	uint16_t t0;
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE){ t0 = TCNT1; }
+	for(uint8_t rep=0;rep<16;rep++){
+		for(uint16_t l=0;l<n;l++){
+			uint16_t base = l - l % MATRIZ_ANCHO;
+			MuestraTransicion m = transicion_pixel(&trans, l % MATRIZ_ANCHO);
+			const Color *a = &paleta_frames[pgm_read_byte(frame1 + base + m.x_sal) & 0x0F];
+			const Color *b = &paleta_frames[pgm_read_byte(frame2 + base + m.x_ent) & 0x0F];
+			sumidero = canal_mezcla(a, b, offsetof(Color, g), m.peso);
+			sumidero = canal_mezcla(a, b, offsetof(Color, r), m.peso);
+			sumidero = canal_mezcla(a, b, offsetof(Color, b), m.peso);
+		}
+	}
+	uint16_t t1;
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE){ t1 = TCNT1; }
+	(void)sumidero;
+	return (uint32_t)(uint16_t)(t1 - t0) * US_POR_TICK / 16;
+}
+
+void reportar_mezcla(){
+	UART_print_P(PSTR("\nMezcla por frame (us), 64 LEDs: ")); UART_print_num(medir_mezcla(64));
+	UART_print_P(PSTR("  256 LEDs: ")); UART_print_num(medir_mezcla(256));
+	UART_print_P(PSTR("  Transmision 256 LEDs (us): ")); UART_print_num((uint32_t)NUM_LEDS*30);
+	UART_send('\n');
+}
 
 // Setup 
 void setup(){ 
-	DDRD|=(1<<DATA_PIN); UART_init(); 
+	DDRD|=(1<<DATA_PIN); UART_init(); timer1_init(); sei();
 	}
 
 void show_menu(){
@@ -200,6 +697,15 @@ void show_menu(){
 	UART_print_P(PSTR("  1. Perrito\n"));
 	UART_print_P(PSTR("  2. Fantasma\n"));
 	UART_print_P(PSTR("  3. Inicializacion\n"));
+	UART_print_P(PSTR("  4. Texto desplazable (60 fps)\n"));
+	UART_print_P(PSTR("  P/p. Reanudar animacion.\n"));
+	UART_print_P(PSTR("  S/s. Detener animacion.\n"));
+	UART_print_P(PSTR("  J/j. Reportar jitter de frames.\n"));
+	UART_print_P(PSTR("  +/-. Subir/bajar brillo global.\n"));
+	UART_print_P(PSTR("  I/i. Brillo y corriente estimada.\n"));
+	UART_print_P(PSTR("  X/x. Cambiar transicion entre frames.\n"));
+	UART_print_P(PSTR("  B/b. Medir costo de la mezcla (64 y 256 LEDs).\n"));
+	UART_print_P(PSTR("  T1/T2/T3. Streaming desde el host a 115200/500000/1000000 baud.\n"));
 	UART_print_P(PSTR("  M/m. Visualizar menu.\n"));
 	UART_print_P(PSTR("============================================\n"));
 }
@@ -208,102 +714,126 @@ int main(void){
 	_delay_ms(1000);
 	while(UCSR0A & (1<<RXC0)) (void)UDR0; // limpiar buffer (mejor impresión UART)
 
-	// Variables de control
-	uint8_t modo = 3;             // Se comienza con la inicialización
-	uint8_t frame_index = 0;      // para animaciones normales
-	uint32_t contador = 0;
-	uint8_t init_frame_index = 0;
-	uint32_t init_contador = 0;
-
-	// Secuencias de animaciones
-	const uint8_t *secuencia_perrito[] = {
-		frame1, frame2, frame1, frame2, frame1, frame2, frame1, frame2,
-		frame3, frame2, frame3, frame2, frame3, frame4, frame5, frame4,
-		frame5, frame4, frame4, frame5, frame4, frame3, frame2, frame6
-	};
-	
-	// Tiempo de cada frame de la animación
-	const uint16_t duracion_perrito[] = {
-		200,200,200,200,200,200,200,200,
-		400,400,400,400,400,400,400,400,
-		400,400,400,400,400,400,400,800
-	};
-
-	const uint8_t *secuencia_fantasma[] = {
-		frameA, frameB, frameC, frameD, frameE, frameF, frameE, frameD
-	};
-	const uint16_t duracion_fantasma[] = {
-		250, 250, 250, 250, 250, 250, 250, 250
-	};
-
 	show_menu(); // muestra el menú al inicio
 
+	UART_print_P(PSTR("\nInicializacion de matriz LED RGB.\n"));
+	iniciar_modo(3); // Se comienza con la inicialización
+
+	uint8_t esperando_velocidad = 0; // Después de 'T' el próximo carácter elige la velocidad
 	while(1){
 		char rx = UART_check_receive();
 
+		// Selector de T1/T2/T3: se espera sin frenar el lazo (la matriz sigue actualizándose)
+		if(rx && esperando_velocidad){
+			esperando_velocidad = 0;
+			modo_streaming(rx);
+			rx = 0;
+		}
+
 		// Menú rápido
 		if(rx=='m'||rx=='M') show_menu();
+		if(rx=='j'||rx=='J') reportar_jitter();
+		if(rx=='i'||rx=='I') reportar_salida();
+		if(rx=='b'||rx=='B') reportar_mezcla();
+		if(rx=='x'||rx=='X'){
+			trans.tipo = (trans.tipo + 1) % TRANS_CANTIDAD;
+			UART_print_P(PSTR("\nTransicion: "));
+			if(trans.tipo==TRANS_NINGUNA) UART_print_P(PSTR("corte\n"));
+			else if(trans.tipo==TRANS_FUNDIDO) UART_print_P(PSTR("fundido\n"));
+			else if(trans.tipo==TRANS_CORTINA) UART_print_P(PSTR("cortina\n"));
+			else UART_print_P(PSTR("deslizar\n"));
+		}
+		if(rx=='+'){
+			salida_set_brillo(salida_brillo > 255-PASO_BRILLO ? 255 : salida_brillo+PASO_BRILLO);
+			reportar_salida();
+		}
+		if(rx=='-'){
+			salida_set_brillo(salida_brillo < PASO_BRILLO ? 0 : salida_brillo-PASO_BRILLO);
+			reportar_salida();
+		}
 
 		// Selección modo
 		if(rx=='1'){
-			modo = 1;
-			frame_index = 0;
-			contador = 0;
 			UART_print_P(PSTR("\nAnimacion: Perrito\n"));
-			mostrarFrameColor(secuencia_perrito[frame_index]); // muestra primer frame 
+			iniciar_modo(1);
 		}
 		if(rx=='2'){
-			modo = 2;
-			frame_index = 0;
-			contador = 0;
 			UART_print_P(PSTR("\nAnimacion: Fantasma\n"));
-			mostrarFrameColor(secuencia_fantasma[frame_index]); 
+			iniciar_modo(2);
 		}
 		if(rx=='3'){
-			modo = 3;
-			init_frame_index = 0;
-			init_contador = 0;
+			UART_print_P(PSTR("\nInicializacion de matriz LED RGB.\n"));
+			iniciar_modo(3);
 		}
-
-		// Ejecutar animaciones
-		if(modo==1){ // Perrito
-			contador++;
-			if(contador >= duracion_perrito[frame_index]){
-				contador = 0;
-				mostrarFrameColor(secuencia_perrito[frame_index]);
-				frame_index++;
-				if(frame_index >= (sizeof(secuencia_perrito)/sizeof(secuencia_perrito[0]))) frame_index = 0;
-			}
+		if(rx=='4'){
+			UART_print_P(PSTR("\nTexto desplazable\n"));
+			iniciar_modo(4);
 		}
-		else if(modo==2){ // Fantasma
-			contador++;
-			if(contador >= duracion_fantasma[frame_index]){
-				contador = 0;
-				mostrarFrameColor(secuencia_fantasma[frame_index]);
-				frame_index++;
-				if(frame_index >= (sizeof(secuencia_fantasma)/sizeof(secuencia_fantasma[0]))) frame_index = 0;
-			}
+		if((rx=='s'||rx=='S') && reproduciendo){
+			detener();
+			UART_print_P(PSTR("\nAnimacion detenida\n"));
+		}
+		if(rx=='t'||rx=='T') esperando_velocidad = 1;
+		if((rx=='p'||rx=='P') && !reproduciendo && modo!=0){
+			reanudar();
+			UART_print_P(PSTR("\nAnimacion reanudada\n"));
 		}
-		else if(modo==3){ // Inicialización no bloqueante
-			// Al iniciar, mostrar mensaje solo en el primer frame
-			if(init_frame_index == 0 && init_contador == 0){
-				UART_print_P(PSTR("\nInicializacion de matriz LED RGB.\n"));
-			}
 
-			init_contador++;
-			if(init_contador >= init_tiempos[init_frame_index]){
-				init_contador = 0;
-				mostrarColor(init_colores[init_frame_index][0],
-				init_colores[init_frame_index][1],
-				init_colores[init_frame_index][2]);
-				init_frame_index++;
+		// Mostrar el frame preparado cuando el Timer1 lo indica
+		if(frame_vencido){
+			uint16_t ahora;
+			ATOMIC_BLOCK(ATOMIC_RESTORESTATE){
+				frame_vencido = 0;
+				ahora = TCNT1;
+				registrar_latencia(ahora - hora_frame);
+			}
+			// Entre dos frames de PROGMEM distintos la transición reemplaza al corte: arranca ahora y
+			// se va enviando en las vueltas siguientes; la primera imagen es igual al frame saliente
+			const uint8_t *anterior = hay_visible ? paso_visible.frame : NULL;
+			paso_visible = paso_listo;
+			if(trans.tipo!=TRANS_NINGUNA && anterior && paso_visible.frame && !paso_visible.buffer
+				&& anterior!=paso_visible.frame){
+				frame_saliente = anterior;
+				inicio_transicion = ahora;
+			}else{
+				frame_saliente = NULL;
+				mostrar_paso(&paso_visible);
+			}
 
-				if(init_frame_index >= NUM_COLORES_INICIALIZACION){
+			// Avanzar y preparar el siguiente paso mientras este se ve
+			paso_idx++;
+			if(paso_idx >= largo_modo(modo)){
+				paso_idx = 0;
+				if(modo==3){
+					detener();
+					modo = 0;
 					UART_print_P(PSTR("Inicializacion correcta.\n")); // mensaje al final
-					modo = 0; 
+					continue;
 				}
 			}
+			preparar_paso();
+		}
+		// Transición en curso: se envía sin pausa, con el progreso según el tiempo transcurrido
+		else if(frame_saliente){
+			uint16_t ahora;
+			ATOMIC_BLOCK(ATOMIC_RESTORESTATE){ ahora = TCNT1; }
+			uint16_t dt = ahora - inicio_transicion;
+			if(dt >= MS_A_TICKS(TRANSICION_MS)){
+				frame_saliente = NULL;
+				mostrar_paso(&paso_visible);
+			}else{
+				trans.progreso = (uint32_t)dt * 255 / MS_A_TICKS(TRANSICION_MS);
+				mostrarTransicion(frame_saliente, paso_visible.frame);
+				ultimo_envio = ahora;
+			}
+		}
+#if SALIDA_DITHER
+		// Sin frame nuevo: reenviar el visible para que el dithering temporal promedie
+		else if(hay_visible){
+			uint16_t ahora;
+			ATOMIC_BLOCK(ATOMIC_RESTORESTATE){ ahora = TCNT1; }
+			if((uint16_t)(ahora - ultimo_envio) >= MS_A_TICKS(REFRESCO_MS)) mostrar_paso(&paso_visible);
 		}
-		delay_variable_ms(1); // avanza contador 
+#endif
 	}
 }
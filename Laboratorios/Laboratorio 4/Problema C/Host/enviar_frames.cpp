@@ -0,0 +1,300 @@
+// Envío de frames en vivo a la matriz 16x16 (Laboratorio 4 - Problema C, comando T del menú)
+// Compilar (Linux):  g++ -std=c++17 -O2 -o enviar_frames enviar_frames.cpp
+//
+// Uso:
+//   ./enviar_frames /dev/ttyUSB0 [opciones] [frame.txt ...]
+//     --baud 1|2|3        115200 / 500000 / 1000000 baud (por defecto 3)
+//     --modo crudo|paleta  768 bytes G-R-B por frame, o paleta + índices de 4 bits (por defecto paleta)
+//     --fps N              limitar la tasa de envío (0 = lo más rápido posible)
+//     --frames N           cantidad de frames a enviar (por defecto 300)
+//     --progresivo         la matriz no es serpentina
+//     --bench              medir fps sostenidos para cada baud y modo
+// Los frames .txt son los mismos de "Frame /Perrito" y "Frame /Fantasma" (16x16 índices de color).
+// Sin frames se envía un patrón de prueba que se desplaza.
+
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+#include <sys/select.h>
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr int ANCHO = 16;
+constexpr int ALTO = 16;
+constexpr int NUM_LEDS = ANCHO * ALTO;
+
+constexpr uint8_t SYNC1 = 0xA5, SYNC2 = 0x5A;
+constexpr uint8_t T_PING = 0x00, T_CRUDO = 0x01, T_PALETA = 0x02, T_SALIR = 0x03;
+constexpr uint8_t ACK = 0x06, NAK = 0x15;
+
+struct RGB { uint8_t r, g, b; };
+
+// Misma tabla de colores que decodificarFrame() en Código.c
+const RGB paleta_frames[16] = {
+	{0, 0, 0}, {253, 30, 0}, {128, 64, 0}, {255, 200, 255}, {128, 0, 32}, {0, 0, 0},
+	{0, 0, 255}, {0, 150, 255}, {253, 166, 0}, {128, 64, 0}, {255, 0, 0}, {0, 255, 0},
+	{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}
+};
+
+using Frame = std::array<uint8_t, NUM_LEDS>;  // índices de color, orden lógico fila por fila
+
+uint16_t crc_xmodem(uint16_t crc, uint8_t b) {
+	crc ^= (uint16_t)b << 8;
+	for (int i = 0; i < 8; i++) crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : (crc << 1);
+	return crc;
+}
+
+speed_t velocidad(int sel) {
+	if (sel == 1) return B115200;
+	if (sel == 2) return B500000;
+	return B1000000;
+}
+
+long baudios(int sel) {
+	if (sel == 1) return 115200;
+	if (sel == 2) return 500000;
+	return 1000000;
+}
+
+bool configurar(int fd, speed_t v) {
+	termios t{};
+	if (tcgetattr(fd, &t) != 0) return false;
+	cfmakeraw(&t);
+	t.c_cflag |= CLOCAL | CREAD;
+	t.c_cc[VMIN] = 0;
+	t.c_cc[VTIME] = 0;
+	cfsetispeed(&t, v);
+	cfsetospeed(&t, v);
+	if (tcsetattr(fd, TCSANOW, &t) != 0) return false;
+	tcflush(fd, TCIOFLUSH);
+	return true;
+}
+
+bool escribir(int fd, const std::vector<uint8_t> &d) {
+	size_t hecho = 0;
+	while (hecho < d.size()) {
+		ssize_t n = write(fd, d.data() + hecho, d.size() - hecho);
+		if (n < 0) return false;
+		hecho += (size_t)n;
+	}
+	return true;
+}
+
+// Espera un byte de respuesta; -1 si vence el tiempo
+int leer_byte(int fd, int timeout_ms) {
+	fd_set s;
+	FD_ZERO(&s);
+	FD_SET(fd, &s);
+	timeval tv{timeout_ms / 1000, (timeout_ms % 1000) * 1000};
+	if (select(fd + 1, &s, nullptr, nullptr, &tv) <= 0) return -1;
+	uint8_t b;
+	return (read(fd, &b, 1) == 1) ? b : -1;
+}
+
+// Espera ACK/NAK ignorando cualquier otro byte (texto del menú, etc.)
+int esperar_respuesta(int fd, int timeout_ms) {
+	auto fin = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+	while (std::chrono::steady_clock::now() < fin) {
+		int b = leer_byte(fd, timeout_ms);
+		if (b == ACK || b == NAK) return b;
+	}
+	return -1;
+}
+
+std::vector<uint8_t> armar_paquete(uint8_t tipo, const std::vector<uint8_t> &datos) {
+	std::vector<uint8_t> p = {SYNC1, SYNC2, tipo, (uint8_t)(datos.size() & 0xFF), (uint8_t)(datos.size() >> 8)};
+	p.insert(p.end(), datos.begin(), datos.end());
+	uint16_t crc = 0;
+	for (size_t i = 2; i < p.size(); i++) crc = crc_xmodem(crc, p[i]);
+	p.push_back(crc & 0xFF);
+	p.push_back(crc >> 8);
+	return p;
+}
+
+// Posición en orden de cableado (igual que matriz.h con MATRIZ_SERPENTINA)
+int logico(int p, bool serpentina) {
+	int fila = p / ANCHO, col = p % ANCHO;
+	if (serpentina && (fila & 1)) col = ANCHO - 1 - col;
+	return fila * ANCHO + col;
+}
+
+std::vector<uint8_t> datos_crudo(const Frame &f, bool serpentina) {
+	std::vector<uint8_t> d;
+	d.reserve(NUM_LEDS * 3);
+	for (int p = 0; p < NUM_LEDS; p++) {
+		const RGB &c = paleta_frames[f[logico(p, serpentina)] & 0x0F];
+		d.push_back(c.g); d.push_back(c.r); d.push_back(c.b);
+	}
+	return d;
+}
+
+std::vector<uint8_t> datos_paleta(const Frame &f, bool serpentina) {
+	std::vector<uint8_t> d = {16};
+	for (const RGB &c : paleta_frames) { d.push_back(c.g); d.push_back(c.r); d.push_back(c.b); }
+	for (int p = 0; p < NUM_LEDS; p += 2) {
+		uint8_t a = f[logico(p, serpentina)] & 0x0F, b = f[logico(p + 1, serpentina)] & 0x0F;
+		d.push_back((uint8_t)(a << 4 | b));
+	}
+	return d;
+}
+
+bool cargar_frame(const std::string &ruta, Frame &f) {
+	std::ifstream in(ruta);
+	if (!in) return false;
+	std::stringstream ss;
+	ss << in.rdbuf();
+	std::string txt = ss.str();
+	for (char &c : txt) if (c == ',') c = ' ';
+	std::istringstream nums(txt);
+	int v, i = 0;
+	while (i < NUM_LEDS && nums >> v) f[i++] = (uint8_t)v;
+	for (; i < NUM_LEDS; i++) f[i] = 0;
+	return true;
+}
+
+std::vector<Frame> patron_prueba() {
+	std::vector<Frame> v(ANCHO);
+	const uint8_t colores[] = {1, 2, 3, 4, 6, 7, 8, 10, 11};
+	for (int k = 0; k < ANCHO; k++)
+		for (int y = 0; y < ALTO; y++)
+			for (int x = 0; x < ANCHO; x++)
+				v[k][y * ANCHO + x] = colores[(x + y + k) % sizeof(colores)];
+	return v;
+}
+
+// Entra en modo streaming: 'T' + selección a 9600, cambio de baud y ping hasta tener ACK
+bool entrar_streaming(int fd, int sel) {
+	if (!configurar(fd, B9600)) return false;
+	std::vector<uint8_t> cmd = {'T', (uint8_t)('0' + sel)};
+	escribir(fd, cmd);
+	tcdrain(fd);
+	usleep(60000);
+	if (!configurar(fd, velocidad(sel))) return false;
+	auto ping = armar_paquete(T_PING, {});
+	for (int i = 0; i < 20; i++) {
+		escribir(fd, ping);
+		if (esperar_respuesta(fd, 100) == ACK) return true;
+	}
+	return false;
+}
+
+void salir_streaming(int fd) {
+	escribir(fd, armar_paquete(T_SALIR, {}));
+	esperar_respuesta(fd, 200);
+	usleep(20000);
+	configurar(fd, B9600);
+}
+
+struct Resultado { int enviados = 0, nak = 0, timeouts = 0; double segundos = 0; };
+
+Resultado enviar(int fd, const std::vector<Frame> &frames, int cantidad, bool paleta,
+		bool serpentina, int fps) {
+	std::vector<std::vector<uint8_t>> paquetes;
+	for (const Frame &f : frames)
+		paquetes.push_back(armar_paquete(paleta ? T_PALETA : T_CRUDO,
+			paleta ? datos_paleta(f, serpentina) : datos_crudo(f, serpentina)));
+
+	Resultado r;
+	auto periodo = std::chrono::microseconds(fps > 0 ? 1000000 / fps : 0);
+	auto inicio = std::chrono::steady_clock::now();
+	auto proximo = inicio;
+	for (int i = 0; i < cantidad; i++) {
+		if (fps > 0) {
+			while (std::chrono::steady_clock::now() < proximo) usleep(200);
+			proximo += periodo;
+		}
+		escribir(fd, paquetes[i % paquetes.size()]);
+		int resp = esperar_respuesta(fd, 250);
+		if (resp == ACK) r.enviados++;
+		else if (resp == NAK) r.nak++;
+		else {
+			// Sin respuesta: resincronizar con un ping antes de seguir
+			r.timeouts++;
+			escribir(fd, armar_paquete(T_PING, {}));
+			esperar_respuesta(fd, 250);
+		}
+	}
+	r.segundos = std::chrono::duration<double>(std::chrono::steady_clock::now() - inicio).count();
+	return r;
+}
+
+// Cota teórica: bytes del paquete por UART + 7,68 ms de envío a los 256 LEDs (30 us por LED)
+double fps_teorico(size_t bytes_paquete, long baud) {
+	double t = bytes_paquete * 10.0 / baud + NUM_LEDS * 30e-6 + 11 * 10.0 / baud;
+	return 1.0 / t;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+	if (argc < 2) {
+		std::fprintf(stderr, "uso: %s <puerto> [--baud 1|2|3] [--modo crudo|paleta] [--fps N] "
+			"[--frames N] [--progresivo] [--bench] [frame.txt ...]\n", argv[0]);
+		return 1;
+	}
+	const char *puerto = argv[1];
+	int sel = 3, fps = 0, cantidad = 300;
+	bool paleta = true, serpentina = true, bench = false;
+	std::vector<Frame> frames;
+
+	for (int i = 2; i < argc; i++) {
+		std::string a = argv[i];
+		if (a == "--baud" && i + 1 < argc) sel = std::atoi(argv[++i]);
+		else if (a == "--modo" && i + 1 < argc) paleta = std::string(argv[++i]) != "crudo";
+		else if (a == "--fps" && i + 1 < argc) fps = std::atoi(argv[++i]);
+		else if (a == "--frames" && i + 1 < argc) cantidad = std::atoi(argv[++i]);
+		else if (a == "--progresivo") serpentina = false;
+		else if (a == "--bench") bench = true;
+		else {
+			Frame f;
+			if (!cargar_frame(a, f)) { std::fprintf(stderr, "No se pudo leer %s\n", a.c_str()); return 1; }
+			frames.push_back(f);
+		}
+	}
+	if (sel < 1 || sel > 3) sel = 3;
+	if (frames.empty()) frames = patron_prueba();
+
+	int fd = open(puerto, O_RDWR | O_NOCTTY);
+	if (fd < 0) { std::perror(puerto); return 1; }
+
+	if (!bench) {
+		if (!entrar_streaming(fd, sel)) { std::fprintf(stderr, "La placa no respondió al ping\n"); return 1; }
+		Resultado r = enviar(fd, frames, cantidad, paleta, serpentina, fps);
+		salir_streaming(fd);
+		std::printf("%d frames en %.2f s -> %.1f fps (NAK %d, sin respuesta %d)\n",
+			r.enviados, r.segundos, r.enviados / r.segundos, r.nak, r.timeouts);
+		close(fd);
+		return 0;
+	}
+
+	// Benchmark: fps sostenidos contra baud para los dos formatos
+	std::printf("%-9s %-7s %8s %10s %10s %5s %5s\n", "baud", "modo", "bytes", "fps", "teorico", "NAK", "t/o");
+	for (int s = 1; s <= 3; s++) {
+		for (int m = 0; m < 2; m++) {
+			bool pal = (m == 1);
+			size_t bytes = armar_paquete(pal ? T_PALETA : T_CRUDO,
+				pal ? datos_paleta(frames[0], serpentina) : datos_crudo(frames[0], serpentina)).size();
+			if (!entrar_streaming(fd, s)) {
+				std::printf("%-9ld %-7s sin respuesta\n", baudios(s), pal ? "paleta" : "crudo");
+				continue;
+			}
+			Resultado r = enviar(fd, frames, cantidad, pal, serpentina, 0);
+			salir_streaming(fd);
+			std::printf("%-9ld %-7s %8zu %10.1f %10.1f %5d %5d\n", baudios(s), pal ? "paleta" : "crudo",
+				bytes, r.enviados / r.segundos, fps_teorico(bytes, baudios(s)), r.nak, r.timeouts);
+		}
+	}
+	close(fd);
+	return 0;
+}
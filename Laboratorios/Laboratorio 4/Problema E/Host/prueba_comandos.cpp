@@ -0,0 +1,269 @@
+// Prueba de carga de los comandos por paquetes del robot (Laboratorio 4 - Problema E)
+// Compilar (Linux):  g++ -std=c++17 -O2 -o prueba_comandos prueba_comandos.cpp
+//
+// Uso:
+//   ./prueba_comandos /dev/rfcomm0 [opciones]
+//     --baud N             velocidad del puerto (por defecto 9600, la del módulo Bluetooth)
+//     --paquetes N         cantidad de paquetes a enviar (por defecto 1000)
+//     --ventana N          paquetes en vuelo sin respuesta (1..64, por defecto 4)
+//     --timeout MS         sin ACK en este tiempo el paquete cuenta como perdido (por defecto 500)
+//     --control            mandar PAQ_CONTROL con motores en 0 y servo/cara sin cambio en lugar de PING
+//     --mezclar            intercalar un comando de una letra ('G', servo en reposo) entre paquetes
+// El robot responde cada paquete con ACK/NAK y su número de secuencia; se mide cuántos se pierden
+// y la latencia ida y vuelta. Antes y después se piden los contadores del robot (PAQ_ESTADO) para
+// saber si lo perdido se cayó en el buffer de recepción o llegó con errores.
+
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+#include <sys/select.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+namespace {
+
+using Reloj = std::chrono::steady_clock;
+
+constexpr uint8_t SYNC1 = 0xA5, SYNC2 = 0x5A;
+constexpr uint8_t T_PING = 0x00, T_CONTROL = 0x01, T_ESTADO = 0x02;
+constexpr uint8_t ACK = 0x06, NAK = 0x15;
+constexpr uint8_t SIN_CAMBIO = 0xFF;
+
+uint16_t crc_xmodem(uint16_t crc, uint8_t b) {
+	crc ^= (uint16_t)b << 8;
+	for (int i = 0; i < 8; i++) crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : (crc << 1);
+	return crc;
+}
+
+speed_t velocidad(long baud) {
+	switch (baud) {
+		case 19200: return B19200;
+		case 38400: return B38400;
+		case 57600: return B57600;
+		case 115200: return B115200;
+		default: return B9600;
+	}
+}
+
+bool configurar(int fd, speed_t v) {
+	termios t{};
+	if (tcgetattr(fd, &t) != 0) return false;
+	cfmakeraw(&t);
+	t.c_cflag |= CLOCAL | CREAD;
+	t.c_cc[VMIN] = 0;
+	t.c_cc[VTIME] = 0;
+	cfsetispeed(&t, v);
+	cfsetospeed(&t, v);
+	if (tcsetattr(fd, TCSANOW, &t) != 0) return false;
+	tcflush(fd, TCIOFLUSH);
+	return true;
+}
+
+bool escribir(int fd, const std::vector<uint8_t> &d) {
+	size_t hecho = 0;
+	while (hecho < d.size()) {
+		ssize_t n = write(fd, d.data() + hecho, d.size() - hecho);
+		if (n < 0) return false;
+		hecho += (size_t)n;
+	}
+	return true;
+}
+
+// Espera un byte; -1 si vence el tiempo
+int leer_byte(int fd, int timeout_ms) {
+	fd_set s;
+	FD_ZERO(&s);
+	FD_SET(fd, &s);
+	timeval tv{timeout_ms / 1000, (timeout_ms % 1000) * 1000};
+	if (select(fd + 1, &s, nullptr, nullptr, &tv) <= 0) return -1;
+	uint8_t b;
+	return (read(fd, &b, 1) == 1) ? b : -1;
+}
+
+// Mismo armado que procesar_serial() en Código: largo de un byte, CRC de tipo, largo y datos
+std::vector<uint8_t> armar_paquete(uint8_t tipo, const std::vector<uint8_t> &datos) {
+	std::vector<uint8_t> p = {SYNC1, SYNC2, tipo, (uint8_t)datos.size()};
+	p.insert(p.end(), datos.begin(), datos.end());
+	uint16_t crc = 0;
+	for (size_t i = 2; i < p.size(); i++) crc = crc_xmodem(crc, p[i]);
+	p.push_back(crc & 0xFF);
+	p.push_back(crc >> 8);
+	return p;
+}
+
+// Separa las respuestas (ACK/NAK + secuencia) del texto que manda el robot ("! OBS !", etc.)
+struct Lector {
+	int pendiente = -1;   // ACK o NAK esperando su número de secuencia
+
+	// Devuelve true y completa r/seq cuando termina una respuesta
+	bool alimentar(uint8_t b, uint8_t &r, uint8_t &seq) {
+		if (pendiente >= 0) {
+			r = (uint8_t)pendiente;
+			seq = b;
+			pendiente = -1;
+			return true;
+		}
+		if (b == ACK || b == NAK) pendiente = b;
+		return false;
+	}
+};
+
+struct Contadores { int perdidos = -1, errores = -1; };
+
+// Pide PAQ_ESTADO y espera ACK + 4 bytes; deja el puerto sin respuestas pendientes
+Contadores consultar_estado(int fd, uint8_t seq) {
+	Contadores c;
+	usleep(300000);
+	tcflush(fd, TCIFLUSH);
+	escribir(fd, armar_paquete(T_ESTADO, {seq}));
+	Lector lector;
+	auto fin = Reloj::now() + std::chrono::milliseconds(1000);
+	while (Reloj::now() < fin) {
+		int b = leer_byte(fd, 100);
+		if (b < 0) continue;
+		uint8_t r, s;
+		if (!lector.alimentar((uint8_t)b, r, s) || s != seq || r != ACK) continue;
+		uint8_t d[4];
+		for (int i = 0; i < 4; i++) {
+			int x = leer_byte(fd, 200);
+			if (x < 0) return c;
+			d[i] = (uint8_t)x;
+		}
+		c.perdidos = d[0] | (d[1] << 8);
+		c.errores = d[2] | (d[3] << 8);
+		break;
+	}
+	return c;
+}
+
+struct EnVuelo { bool activo = false; Reloj::time_point enviado; };
+
+struct Resultado {
+	int enviados = 0, ack = 0, nak = 0, perdidos = 0, fuera_de_orden = 0;
+	std::vector<double> latencias_ms;
+	double segundos = 0;
+};
+
+Resultado correr(int fd, int cantidad, int ventana, int timeout_ms, bool control, bool mezclar) {
+	Resultado res;
+	std::array<EnVuelo, 256> vuelo{};
+	int en_vuelo = 0;
+	uint8_t seq = 0;
+	Lector lector;
+	auto inicio = Reloj::now();
+
+	while (res.enviados < cantidad || en_vuelo > 0) {
+		// Llenar la ventana
+		while (res.enviados < cantidad && en_vuelo < ventana) {
+			std::vector<uint8_t> p = control
+				? armar_paquete(T_CONTROL, {seq, 0, 0, SIN_CAMBIO, SIN_CAMBIO})
+				: armar_paquete(T_PING, {seq});
+			if (mezclar) p.push_back('G');
+			escribir(fd, p);
+			vuelo[seq].activo = true;
+			vuelo[seq].enviado = Reloj::now();
+			seq++;
+			en_vuelo++;
+			res.enviados++;
+		}
+		// Respuestas
+		int b = leer_byte(fd, 5);
+		if (b >= 0) {
+			uint8_t r, s;
+			if (lector.alimentar((uint8_t)b, r, s)) {
+				if (!vuelo[s].activo) {
+					res.fuera_de_orden++;   // Respuesta tardía de uno ya dado por perdido
+				} else {
+					vuelo[s].activo = false;
+					en_vuelo--;
+					if (r == ACK) {
+						res.ack++;
+						res.latencias_ms.push_back(std::chrono::duration<double, std::milli>(
+							Reloj::now() - vuelo[s].enviado).count());
+					} else {
+						res.nak++;
+					}
+				}
+			}
+		}
+		// Vencidos
+		auto ahora = Reloj::now();
+		for (auto &v : vuelo) {
+			if (v.activo && ahora - v.enviado > std::chrono::milliseconds(timeout_ms)) {
+				v.activo = false;
+				en_vuelo--;
+				res.perdidos++;
+			}
+		}
+	}
+	res.segundos = std::chrono::duration<double>(Reloj::now() - inicio).count();
+	return res;
+}
+
+double percentil(std::vector<double> v, double p) {
+	if (v.empty()) return 0;
+	std::sort(v.begin(), v.end());
+	size_t i = (size_t)(p * (v.size() - 1) + 0.5);
+	return v[i];
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+	if (argc < 2) {
+		std::fprintf(stderr, "uso: %s <puerto> [--baud N] [--paquetes N] [--ventana N] [--timeout MS] "
+			"[--control] [--mezclar]\n", argv[0]);
+		return 1;
+	}
+	const char *puerto = argv[1];
+	long baud = 9600;
+	int cantidad = 1000, ventana = 4, timeout_ms = 500;
+	bool control = false, mezclar = false;
+
+	for (int i = 2; i < argc; i++) {
+		std::string a = argv[i];
+		if (a == "--baud" && i + 1 < argc) baud = std::atol(argv[++i]);
+		else if (a == "--paquetes" && i + 1 < argc) cantidad = std::atoi(argv[++i]);
+		else if (a == "--ventana" && i + 1 < argc) ventana = std::atoi(argv[++i]);
+		else if (a == "--timeout" && i + 1 < argc) timeout_ms = std::atoi(argv[++i]);
+		else if (a == "--control") control = true;
+		else if (a == "--mezclar") mezclar = true;
+		else { std::fprintf(stderr, "Opción desconocida: %s\n", a.c_str()); return 1; }
+	}
+	ventana = std::clamp(ventana, 1, 64);   // Con secuencias de 8 bits no se confunden vueltas
+
+	int fd = open(puerto, O_RDWR | O_NOCTTY);
+	if (fd < 0) { std::perror(puerto); return 1; }
+	if (!configurar(fd, velocidad(baud))) { std::fprintf(stderr, "No se pudo configurar %s\n", puerto); return 1; }
+
+	Contadores antes = consultar_estado(fd, 0xF0);
+	if (antes.perdidos < 0) { std::fprintf(stderr, "El robot no respondió a PAQ_ESTADO\n"); return 1; }
+
+	Resultado r = correr(fd, cantidad, ventana, timeout_ms, control, mezclar);
+	Contadores despues = consultar_estado(fd, 0xF1);
+
+	std::printf("%d paquetes %s en %.2f s (%.1f por segundo), ventana %d\n", r.enviados,
+		control ? "CONTROL" : "PING", r.segundos, r.enviados / r.segundos, ventana);
+	std::printf("ACK %d  NAK %d  perdidos %d (%.2f%%)  respuestas tardías %d\n", r.ack, r.nak,
+		r.perdidos, 100.0 * r.perdidos / r.enviados, r.fuera_de_orden);
+	if (!r.latencias_ms.empty()) {
+		double suma = 0;
+		for (double l : r.latencias_ms) suma += l;
+		std::printf("latencia ida y vuelta (ms): min %.1f  media %.1f  p50 %.1f  p95 %.1f  p99 %.1f  max %.1f\n",
+			percentil(r.latencias_ms, 0), suma / r.latencias_ms.size(), percentil(r.latencias_ms, 0.5),
+			percentil(r.latencias_ms, 0.95), percentil(r.latencias_ms, 0.99), percentil(r.latencias_ms, 1));
+	}
+	if (despues.perdidos >= 0) {
+		std::printf("robot: bytes perdidos en recepción %d, paquetes descartados %d\n",
+			(uint16_t)(despues.perdidos - antes.perdidos), (uint16_t)(despues.errores - antes.errores));
+	}
+	close(fd);
+	return 0;
+}
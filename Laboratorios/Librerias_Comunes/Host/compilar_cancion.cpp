@@ -0,0 +1,213 @@
+// Compilador de canciones al formato empaquetado de cancion.h (Librerias_Comunes)
+// Compilar (Linux):  g++ -std=c++17 -O2 -o compilar_cancion compilar_cancion.cpp
+//
+// Uso:
+//   ./compilar_cancion cancion.txt [otra.txt ...] > canciones.inc
+// Escribe en la salida estándar un arreglo PROGMEM por archivo, listo para pegar en el programa, y
+// en la de errores el tamaño de cada canción.
+//
+// Formato del texto (ver ../Canciones):
+//   # comentario               hasta el fin de la línea
+//   nombre cancion_alegria     nombre del arreglo (por defecto, el del archivo)
+//   tempo 150                  negras por minuto (1..255), se puede cambiar en cualquier lugar
+//   E4/4  C#4/8  Bb3/2.        nota (A..G, # o b, octava 0..7) / duración (1, 2, 4, 8, 16)
+//                              con punto = puntillo
+//   R/8                        silencio
+//   G4/4~                      ligada: suena hasta el final, sin cortar antes de la siguiente
+// Las duraciones posibles son 1, 2, 3, 4, 6, 8, 12 y 16 semicorcheas (16, 8, 8., 4, 4., 2, 2., 1).
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr uint8_t FIN = 0xF8, LIGAR = 0xF9, TEMPO = 0xFA, BASE = 0xFB;
+constexpr int ALTURA_MAX = 30;   // La 31 marca los comandos
+constexpr int MIDI_MIN = 12, MIDI_MAX = 107;
+
+struct Evento {
+	int midi;        // -1 = silencio
+	int codigo;      // Código de duración 0..7
+	bool ligada;
+	int tempo;       // > 0: cambio de tempo antes de esta nota
+};
+
+struct Cancion {
+	std::string nombre;
+	std::vector<Evento> eventos;
+	int tempo_inicial = 120;
+};
+
+bool error(const std::string &archivo, int linea, const std::string &msj) {
+	std::fprintf(stderr, "%s:%d: %s\n", archivo.c_str(), linea, msj.c_str());
+	return false;
+}
+
+// "C#4" -> 61; -1 si no es una nota
+int leer_altura(const std::string &s) {
+	static const int semitono[7] = {9, 11, 0, 2, 4, 5, 7};   // A B C D E F G
+	if (s.size() < 2) return -1;
+	char letra = (char)std::toupper((unsigned char)s[0]);
+	if (letra < 'A' || letra > 'G') return -1;
+	int n = semitono[letra - 'A'];
+	size_t i = 1;
+	if (s[i] == '#') { n++; i++; }
+	else if (s[i] == 'b') { n--; i++; }
+	if (i + 1 != s.size() || !std::isdigit((unsigned char)s[i])) return -1;
+	return (s[i] - '0' + 1) * 12 + n;
+}
+
+// "4." -> código 4 (6 semicorcheas); -1 si no está en la tabla
+int leer_duracion(const std::string &s) {
+	static const int semicorcheas[8] = {1, 2, 3, 4, 6, 8, 12, 16};
+	bool puntillo = !s.empty() && s.back() == '.';
+	std::string num = puntillo ? s.substr(0, s.size() - 1) : s;
+	if (num.empty() || num.find_first_not_of("0123456789") != std::string::npos) return -1;
+	int figura = std::stoi(num);
+	if (figura <= 0 || 16 % figura != 0) return -1;
+	int total = 16 / figura;
+	if (puntillo) {
+		if (total % 2) return -1;
+		total += total / 2;
+	}
+	for (int c = 0; c < 8; c++)
+		if (semicorcheas[c] == total) return c;
+	return -1;
+}
+
+bool leer_archivo(const std::string &archivo, Cancion &c) {
+	std::ifstream f(archivo);
+	if (!f) { std::perror(archivo.c_str()); return false; }
+	size_t barra = archivo.find_last_of('/');
+	c.nombre = archivo.substr(barra == std::string::npos ? 0 : barra + 1);
+	c.nombre = c.nombre.substr(0, c.nombre.find('.'));
+	for (char &ch : c.nombre) if (!std::isalnum((unsigned char)ch)) ch = '_';
+
+	int tempo_pendiente = 0;
+	std::string linea;
+	for (int n = 1; std::getline(f, linea); n++) {
+		size_t com = linea.find('#');
+		// '#' pegado a una letra de nota es un sostenido, no un comentario
+		while (com != std::string::npos && com > 0 && std::isalpha((unsigned char)linea[com - 1]))
+			com = linea.find('#', com + 1);
+		if (com != std::string::npos) linea.erase(com);
+
+		std::istringstream in(linea);
+		std::string t;
+		while (in >> t) {
+			if (t == "nombre") {
+				if (!(in >> c.nombre)) return error(archivo, n, "falta el nombre");
+				continue;
+			}
+			if (t == "tempo") {
+				int bpm = 0;
+				if (!(in >> bpm) || bpm < 1 || bpm > 255) return error(archivo, n, "tempo fuera de 1..255");
+				if (c.eventos.empty()) c.tempo_inicial = bpm;
+				else tempo_pendiente = bpm;
+				continue;
+			}
+			Evento e{-1, 0, false, tempo_pendiente};
+			if (!t.empty() && t.back() == '~') { e.ligada = true; t.pop_back(); }
+			size_t barra_dur = t.find('/');
+			if (barra_dur == std::string::npos) return error(archivo, n, "falta la duración en '" + t + "'");
+			std::string alt = t.substr(0, barra_dur), dur = t.substr(barra_dur + 1);
+			if (alt != "R" && alt != "r" && alt != "-") {
+				e.midi = leer_altura(alt);
+				if (e.midi < MIDI_MIN || e.midi > MIDI_MAX) return error(archivo, n, "nota inválida '" + alt + "' (C0 a B7)");
+			}
+			e.codigo = leer_duracion(dur);
+			if (e.codigo < 0) return error(archivo, n, "duración inválida '" + dur + "' (ligar dos notas con ~)");
+			c.eventos.push_back(e);
+			tempo_pendiente = 0;
+		}
+	}
+	if (c.eventos.empty()) return error(archivo, 0, "la canción no tiene notas");
+	return true;
+}
+
+// La base sale de la nota más grave; si la canción no entra en 30 semitonos se mueve solo cuando
+// una nota queda afuera
+std::vector<uint8_t> empaquetar(const Cancion &c) {
+	int minimo = MIDI_MAX;
+	for (const Evento &e : c.eventos)
+		if (e.midi >= 0) minimo = std::min(minimo, e.midi);
+	int base = minimo - 1;
+
+	std::vector<uint8_t> d = {TEMPO, (uint8_t)c.tempo_inicial, BASE, (uint8_t)base};
+	for (const Evento &e : c.eventos) {
+		if (e.tempo) { d.push_back(TEMPO); d.push_back((uint8_t)e.tempo); }
+		int altura = 0;
+		if (e.midi >= 0) {
+			int nueva = base;
+			if (e.midi - base > ALTURA_MAX) nueva = e.midi - ALTURA_MAX;
+			else if (e.midi - base < 1) nueva = e.midi - 1;
+			if (nueva != base) { d.push_back(BASE); d.push_back((uint8_t)nueva); base = nueva; }
+			altura = e.midi - base;
+		}
+		if (e.ligada) d.push_back(LIGAR);
+		d.push_back((uint8_t)((altura << 3) | e.codigo));
+	}
+	d.push_back(FIN);
+	return d;
+}
+
+const char *nombre_comando(uint8_t b) {
+	switch (b) {
+		case FIN: return "FIN";
+		case LIGAR: return "LIGAR";
+		case TEMPO: return "TEMPO";
+		default: return "BASE";
+	}
+}
+
+void escribir(const std::string &archivo, const Cancion &c, const std::vector<uint8_t> &d) {
+	std::printf("// Generado con compilar_cancion a partir de %s: %zu notas, %zu bytes\n",
+		archivo.c_str(), c.eventos.size(), d.size());
+	// Un comando y su argumento van juntos en el texto
+	std::vector<std::string> elementos;
+	char buf[24];
+	for (size_t i = 0; i < d.size(); i++) {
+		if (d[i] >= FIN && (d[i] == TEMPO || d[i] == BASE) && i + 1 < d.size()) {
+			std::snprintf(buf, sizeof buf, "CANCION_%s, %u", nombre_comando(d[i]), d[i + 1]);
+			i++;
+		} else if (d[i] >= FIN) {
+			std::snprintf(buf, sizeof buf, "CANCION_%s", nombre_comando(d[i]));
+		} else {
+			std::snprintf(buf, sizeof buf, "0x%02X", d[i]);
+		}
+		elementos.push_back(buf);
+	}
+	std::printf("const uint8_t %s[] PROGMEM = {", c.nombre.c_str());
+	for (size_t i = 0; i < elementos.size(); i++) {
+		std::printf("%s%s", (i % 12) ? ", " : (i ? ",\n    " : "\n    "), elementos[i].c_str());
+	}
+	std::printf("\n};\n\n");
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+	if (argc < 2) {
+		std::fprintf(stderr, "uso: %s cancion.txt [otra.txt ...]\n", argv[0]);
+		return 1;
+	}
+	int errores = 0;
+	for (int i = 1; i < argc; i++) {
+		Cancion c;
+		if (!leer_archivo(argv[i], c)) { errores++; continue; }
+		std::vector<uint8_t> d = empaquetar(c);
+		escribir(argv[i], c, d);
+		// Referencias: una llamada "if(reproducir_tono(f, d)) return;" son ~14 bytes de código
+		// (cargar dos argumentos de 16 bits, call, probar el resultado y saltar) y una entrada de
+		// tabla (incremento de 16 bits + duración) son 3 bytes
+		std::fprintf(stderr, "%s: %zu notas en %zu bytes (llamadas: ~%zu bytes, tabla de 3 bytes: %zu)\n",
+			c.nombre.c_str(), c.eventos.size(), d.size(), c.eventos.size() * 14, c.eventos.size() * 3 + 3);
+	}
+	return errores ? 1 : 0;
+}
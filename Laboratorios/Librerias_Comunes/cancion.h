@@ -0,0 +1,130 @@
+// Canciones empaquetadas en PROGMEM y su lector (compartido por Lab 2 - Problema C y Lab 4 - Problema E)
+// Se agrega la carpeta Librerias_Comunes a las rutas de include del proyecto en microchip.
+//
+// Una canción es una secuencia de bytes que arma Host/compilar_cancion.cpp a partir de un texto
+// (ver Canciones/). Cada nota ocupa un byte:
+//   bits 7..3: altura, 0 = silencio, 1..30 = semitonos sobre la base de la canción
+//   bits 2..0: duración en semicorcheas: 1, 2, 3, 4, 6, 8, 12 o 16 (semicorchea a redonda)
+// La altura 31 marca un comando:
+//   0xF8           fin de la canción
+//   0xF9           la nota que sigue va ligada (suena hasta el final, sin cortar antes de la próxima)
+//   0xFA bpm       tempo en negras por minuto
+//   0xFB midi      nueva base (número de nota MIDI de la altura 0)
+// El compilador siempre empieza con el tempo y la base.
+//
+// El lector no genera sonido: entrega para cada nota el incremento de fase de un acumulador de
+// 16 bits (el del proyecto, que corre a CANCION_FS_HZ) y la duración en ticks de CANCION_TICK_MS.
+// Las notas van de C0 (MIDI 12) a B7 (MIDI 107). El incremento (f * 65536 / CANCION_FS_HZ) entra
+// en 16 bits para cualquier f < CANCION_FS_HZ; el límite real es el de la onda cuadrada que sale
+// del bit alto del acumulador: una nota suena en su altura solo si f < CANCION_FS_HZ / 2 (más
+// arriba se repliega a una nota más grave). A 7812,5 Hz (Lab 4 - Problema E) la más aguda es A#7
+// (3729 Hz); B7 (3951 Hz) necesita más de 7902 Hz. A 20 kHz (Lab 2 - Problema C) entran todas.
+
+#ifndef CANCION_H_
+#define CANCION_H_
+
+#include <avr/pgmspace.h>
+#include <stdint.h>
+
+// Configuración (se puede definir antes de incluir)
+#ifndef CANCION_FS_HZ
+#error "Definir CANCION_FS_HZ (actualizaciones por segundo del acumulador de fase) antes de incluir cancion.h"
+#endif
+#ifndef CANCION_TICK_MS
+#define CANCION_TICK_MS 1    // Unidad de las duraciones que devuelve cancion_siguiente()
+#endif
+
+#define CANCION_FIN    0xF8
+#define CANCION_LIGAR  0xF9
+#define CANCION_TEMPO  0xFA
+#define CANCION_BASE   0xFB
+#define CANCION_COMANDO(b) ((b) >= 0xF8)
+
+// Incrementos de la octava 7 (C7 a B7); las demás se sacan corriendo a la derecha
+#define CANCION_INC(f) ((uint16_t)((f) * 65536.0 / (CANCION_FS_HZ) + 0.5))
+static const uint16_t cancion_inc_octava[12] PROGMEM = {
+	CANCION_INC(2093.00), CANCION_INC(2217.46), CANCION_INC(2349.32), CANCION_INC(2489.02),
+	CANCION_INC(2637.02), CANCION_INC(2793.83), CANCION_INC(2959.96), CANCION_INC(3135.96),
+	CANCION_INC(3322.44), CANCION_INC(3520.00), CANCION_INC(3729.31), CANCION_INC(3951.07)
+};
+// Semicorcheas de cada código de duración
+static const uint8_t cancion_semicorcheas[8] PROGMEM = { 1, 2, 3, 4, 6, 8, 12, 16 };
+
+typedef struct {
+	const uint8_t *pos;          // Próximo byte (PROGMEM); 0 = terminada
+	uint8_t base;                // Nota MIDI de la altura 0
+	uint16_t ticks_semicorchea;
+} Cancion;
+
+typedef struct {
+	uint16_t inc;     // Incremento de fase por actualización (0 = silencio)
+	uint16_t ticks;   // Duración
+	uint8_t ligada;   // 1: no cortar antes de la próxima nota
+} CancionNota;
+
+static inline void cancion_iniciar(Cancion *c, const uint8_t *datos) {
+	c->pos = datos;
+	c->base = 60;
+	c->ticks_semicorchea = 15000 / 120 / CANCION_TICK_MS;
+}
+
+// Ticks de una semicorchea a bpm negras por minuto: 15000 / CANCION_TICK_MS / bpm redondeado, al
+// menos 1. La división va por restas y corrimientos: un "/" sería una llamada a __udivmodhi4 y en
+// una ISR esa llamada haría guardar todos los registros en cada interrupción.
+static inline __attribute__((always_inline)) uint16_t cancion_ticks_semicorchea(uint8_t bpm) {
+	if (!bpm) bpm = 1;
+	uint16_t n = 15000 / CANCION_TICK_MS + (bpm >> 1);
+	uint16_t q = 0, r = 0;
+	for (uint8_t i = 0; i < 16; i++) {
+		r = (r << 1) | (n >> 15);
+		n <<= 1;
+		q <<= 1;
+		if (r >= bpm) {
+			r -= bpm;
+			q |= 1;
+		}
+	}
+	return q ? q : 1;
+}
+
+// Incremento de fase de una nota MIDI (sin divisiones: la octava se busca restando)
+static inline __attribute__((always_inline)) uint16_t cancion_inc(uint8_t midi) {
+	uint8_t octava = 0;
+	while (midi >= 12) {
+		midi -= 12;
+		octava++;
+	}
+	uint8_t corrimiento = (octava < 8) ? 8 - octava : 0;
+	uint16_t inc = pgm_read_word(&cancion_inc_octava[midi]);
+	return corrimiento ? ((inc >> (corrimiento - 1)) + 1) >> 1 : inc;
+}
+
+// Lee la próxima nota; devuelve 0 al llegar al fin. Siempre inline: los proyectos la llaman desde
+// una ISR y así la ISR no hace llamadas (no guarda todos los registros en cada interrupción).
+static inline __attribute__((always_inline)) uint8_t cancion_siguiente(Cancion *c, CancionNota *n) {
+	const uint8_t *p = c->pos;
+	if (!p) return 0;
+	n->ligada = 0;
+	for (;;) {
+		uint8_t b = pgm_read_byte(p++);
+		if (!CANCION_COMANDO(b)) {
+			uint8_t altura = b >> 3;
+			n->inc = altura ? cancion_inc(c->base + altura) : 0;
+			n->ticks = (uint16_t)pgm_read_byte(&cancion_semicorcheas[b & 0x07]) * c->ticks_semicorchea;
+			c->pos = p;
+			return 1;
+		}
+		if (b == CANCION_LIGAR) {
+			n->ligada = 1;
+		} else if (b == CANCION_TEMPO) {
+			c->ticks_semicorchea = cancion_ticks_semicorchea(pgm_read_byte(p++));
+		} else if (b == CANCION_BASE) {
+			c->base = pgm_read_byte(p++);
+		} else {
+			c->pos = 0;    // CANCION_FIN (o un comando desconocido)
+			return 0;
+		}
+	}
+}
+
+#endif /* CANCION_H_ */
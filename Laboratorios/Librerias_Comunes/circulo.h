@@ -0,0 +1,86 @@
+// Círculos y arcos por punto medio, solo con enteros (compartido por Lab 2 - Problema A y Lab 3 - Problema A)
+// Se agrega la carpeta Librerias_Comunes a las rutas de include del proyecto en microchip.
+//
+// arco_trazar() recorre la trama de pasos del círculo que pasa por el punto de inicio (centro en
+// 0, 0; coordenadas en pasos del plotter) y llama a paso(dx, dy) con cada paso unitario: dx y dy
+// en -1, 0 o 1 (los dos distintos de 0 = paso diagonal). En cada punto se mira la tangente: el eje
+// en que más avanza da siempre un paso y el otro lo da o no según cuál de los dos candidatos deja
+// más chico el error f = x^2 + y^2 - r^2, que se actualiza con sumas (2x + 1). No hay seno, coseno,
+// raíz ni flotantes, y el punto nunca se aleja más de medio paso del círculo.
+//
+// El arco termina al cruzar la recta del centro al punto final y con unos pasos rectos llega
+// exacto al final, así que con inicio = final el círculo cierra en el mismo paso en que empezó.
+// El ángulo de inicio y de fin se dan como puntos sobre el círculo (x = r cos a, y = r sin a);
+// el radio es el del punto de inicio. Si el inicio o el final es el centro no hay arco (radio 0 o
+// sin recta de llegada, que nunca se cruzaría): se va en línea recta al final.
+
+#ifndef CIRCULO_H_
+#define CIRCULO_H_
+
+#include <stdint.h>
+
+typedef void (*ArcoPaso)(int8_t dx, int8_t dy);
+
+static inline int8_t arco_signo(int32_t v) {
+	return (v > 0) - (v < 0);
+}
+
+// Arco de (x0, y0) a (x1, y1) alrededor de (0, 0), antihorario o horario. Devuelve los pasos dados.
+static uint16_t arco_trazar(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint8_t horario, ArcoPaso paso) {
+	int16_t x = x0, y = y0;
+	int32_t f = 0;   // x^2 + y^2 - r^2 del punto actual
+	uint16_t n = 0;
+	int32_t cruz_ant = (int32_t)x1 * y - (int32_t)y1 * x;   // > 0: el punto ya pasó el final
+	if (horario) cruz_ant = -cruz_ant;
+
+	if ((x0 || y0) && (x1 || y1)) {
+		for (;;) {
+			// Tangente en el sentido del recorrido
+			int16_t tx = horario ? y : -y;
+			int16_t ty = horario ? -x : x;
+			int8_t sx, sy;
+			int32_t fa, fb;
+			if ((tx < 0 ? -tx : tx) >= (ty < 0 ? -ty : ty)) {
+				// Manda x; y baja hacia el centro si la tangente es horizontal
+				sx = arco_signo(tx);
+				sy = ty ? arco_signo(ty) : -arco_signo(y);
+				fa = f + 2 * (int32_t)sx * x + 1;    // (x + sx, y)
+				fb = fa + 2 * (int32_t)sy * y + 1;   // (x + sx, y + sy)
+				if ((fa < 0 ? -fa : fa) <= (fb < 0 ? -fb : fb)) sy = 0;
+			} else {
+				sy = arco_signo(ty);
+				sx = tx ? arco_signo(tx) : -arco_signo(x);
+				fa = f + 2 * (int32_t)sy * y + 1;    // (x, y + sy)
+				fb = fa + 2 * (int32_t)sx * x + 1;   // (x + sx, y + sy)
+				if ((fa < 0 ? -fa : fa) <= (fb < 0 ? -fb : fb)) sx = 0;
+			}
+			// Antes de moverse: ¿el punto nuevo cruza la recta del final?
+			int16_t nx = x + sx, ny = y + sy;
+			int32_t cruz = (int32_t)x1 * ny - (int32_t)y1 * nx;
+			if (horario) cruz = -cruz;
+			if (cruz_ant < 0 && cruz >= 0 && (int32_t)x1 * nx + (int32_t)y1 * ny > 0) break;
+			cruz_ant = cruz;
+			f = (sx && sy) ? fb : fa;
+			x = nx;
+			y = ny;
+			paso(sx, sy);
+			n++;
+		}
+	}
+	// Lo que falta hasta el final exacto (uno o dos pasos, o la diferencia de radio del final)
+	while (x != x1 || y != y1) {
+		int8_t sx = arco_signo((int32_t)x1 - x), sy = arco_signo((int32_t)y1 - y);
+		x += sx;
+		y += sy;
+		paso(sx, sy);
+		n++;
+	}
+	return n;
+}
+
+// Círculo completo de radio r empezando en (r, 0), antihorario
+static inline uint16_t circulo_trazar(int16_t r, ArcoPaso paso) {
+	return arco_trazar(r, 0, r, 0, 0, paso);
+}
+
+#endif /* CIRCULO_H_ */
@@ -0,0 +1,196 @@
+// Geometría de matrices de LEDs WS2812 (compartida por Lab 3 - Problema D, Lab 4 - Problema C y D)
+// Se agrega la carpeta Librerias_Comunes a las rutas de include del proyecto en microchip.
+//
+// Antes de incluir este archivo cada proyecto define la geometría de su matriz:
+//   MATRIZ_ANCHO, MATRIZ_ALTO    -> tamaño lógico (el que usa el dibujo / los frames)
+//   MATRIZ_SERPENTINA            -> 1 si las filas pares/impares del cableado van en sentidos opuestos
+//   MATRIZ_ROTACION              -> 0, 90, 180 o 270 grados (del panel físico respecto al dibujo)
+//   MATRIZ_ESPEJO_X, MATRIZ_ESPEJO_Y -> 1 para invertir columnas / filas del cableado
+//
+// Todo se resuelve en tiempo de compilación: el mapeo queda como un punto de inicio y dos pasos
+// constantes (columna y fila), así que recorrer la matriz en orden de cableado no necesita
+// divisiones, módulos ni ramas por pixel.
+
+#ifndef MATRIZ_H_
+#define MATRIZ_H_
+
+#include <stdint.h>
+#include <avr/pgmspace.h>
+#include <util/crc16.h>
+
+#ifndef MATRIZ_ANCHO
+#error "Definir MATRIZ_ANCHO y MATRIZ_ALTO antes de incluir matriz.h"
+#endif
+
+#ifndef MATRIZ_SERPENTINA
+#define MATRIZ_SERPENTINA 0
+#endif
+#ifndef MATRIZ_ROTACION
+#define MATRIZ_ROTACION 0
+#endif
+#ifndef MATRIZ_ESPEJO_X
+#define MATRIZ_ESPEJO_X 0
+#endif
+#ifndef MATRIZ_ESPEJO_Y
+#define MATRIZ_ESPEJO_Y 0
+#endif
+
+#define MATRIZ_NUM_LEDS (MATRIZ_ANCHO * MATRIZ_ALTO)
+
+// Tamaño del panel tal como está cableado (con 90/270 se intercambian ancho y alto)
+#if MATRIZ_ROTACION == 90 || MATRIZ_ROTACION == 270
+#define MATRIZ_FIS_ANCHO MATRIZ_ALTO
+#define MATRIZ_FIS_ALTO  MATRIZ_ANCHO
+#else
+#define MATRIZ_FIS_ANCHO MATRIZ_ANCHO
+#define MATRIZ_FIS_ALTO  MATRIZ_ALTO
+#endif
+
+// Índice lógico = BASE + columna_fisica * PASO_COL + fila_fisica * PASO_FILA (sin espejos)
+#if MATRIZ_ROTACION == 0
+#define MATRIZ_BASE0     0
+#define MATRIZ_PASO_COL0 1
+#define MATRIZ_PASO_FIL0 MATRIZ_ANCHO
+#elif MATRIZ_ROTACION == 90
+#define MATRIZ_BASE0     (MATRIZ_FIS_ALTO - 1)
+#define MATRIZ_PASO_COL0 MATRIZ_ANCHO
+#define MATRIZ_PASO_FIL0 (-1)
+#elif MATRIZ_ROTACION == 180
+#define MATRIZ_BASE0     ((MATRIZ_ALTO - 1) * MATRIZ_ANCHO + MATRIZ_ANCHO - 1)
+#define MATRIZ_PASO_COL0 (-1)
+#define MATRIZ_PASO_FIL0 (-MATRIZ_ANCHO)
+#elif MATRIZ_ROTACION == 270
+#define MATRIZ_BASE0     ((MATRIZ_FIS_ANCHO - 1) * MATRIZ_ANCHO)
+#define MATRIZ_PASO_COL0 (-MATRIZ_ANCHO)
+#define MATRIZ_PASO_FIL0 1
+#else
+#error "MATRIZ_ROTACION debe ser 0, 90, 180 o 270"
+#endif
+
+// Espejos: se arranca desde el otro extremo y se invierte el paso
+#if MATRIZ_ESPEJO_X
+#define MATRIZ_BASE1     (MATRIZ_BASE0 + (MATRIZ_FIS_ANCHO - 1) * MATRIZ_PASO_COL0)
+#define MATRIZ_PASO_COL  (-(MATRIZ_PASO_COL0))
+#else
+#define MATRIZ_BASE1     MATRIZ_BASE0
+#define MATRIZ_PASO_COL  MATRIZ_PASO_COL0
+#endif
+#if MATRIZ_ESPEJO_Y
+#define MATRIZ_BASE      (MATRIZ_BASE1 + (MATRIZ_FIS_ALTO - 1) * MATRIZ_PASO_FIL0)
+#define MATRIZ_PASO_FILA (-(MATRIZ_PASO_FIL0))
+#else
+#define MATRIZ_BASE      MATRIZ_BASE1
+#define MATRIZ_PASO_FILA MATRIZ_PASO_FIL0
+#endif
+
+// Fila física invertida por el cableado serpentina
+#define MATRIZ_FILA_INVERTIDA(f) (MATRIZ_SERPENTINA && ((f) & 1))
+
+// Índice lógico del LED número p de la cadena (expresión constante si p lo es)
+#define MATRIZ_LOGICO(p) \
+	(MATRIZ_BASE + ((p) / MATRIZ_FIS_ANCHO) * MATRIZ_PASO_FILA + \
+	(MATRIZ_FILA_INVERTIDA((p) / MATRIZ_FIS_ANCHO) ? \
+	(MATRIZ_FIS_ANCHO - 1 - (p) % MATRIZ_FIS_ANCHO) : ((p) % MATRIZ_FIS_ANCHO)) * MATRIZ_PASO_COL)
+
+// ----------------------------------------------------------------------------
+// Recorrido en orden de cableado (iterador con pasos constantes)
+//
+//   for (uint8_t f = 0; f < MATRIZ_FIS_ALTO; f++) {
+//       const uint8_t *p = frame + matriz_inicio_fila(f);
+//       int8_t paso = matriz_paso_fila(f);
+//       for (uint8_t c = 0; c < MATRIZ_FIS_ANCHO; c++, p += paso) { ... }
+//   }
+// ----------------------------------------------------------------------------
+
+// Offset lógico del primer LED de la fila física f
+static inline int16_t matriz_inicio_fila(uint8_t f) {
+	int16_t inicio = MATRIZ_BASE + (int16_t)f * MATRIZ_PASO_FILA;
+	if (MATRIZ_FILA_INVERTIDA(f)) inicio += (MATRIZ_FIS_ANCHO - 1) * MATRIZ_PASO_COL;
+	return inicio;
+}
+
+// Paso lógico entre LEDs consecutivos de la fila física f
+static inline int8_t matriz_paso_fila(uint8_t f) {
+	return MATRIZ_FILA_INVERTIDA(f) ? -(MATRIZ_PASO_COL) : MATRIZ_PASO_COL;
+}
+
+// Posición en la cadena del pixel lógico (x, y); para dibujar en buffers que se envían tal cual
+static inline uint16_t matriz_xy(uint8_t x, uint8_t y) {
+	uint8_t c, f;
+#if MATRIZ_ROTACION == 0
+	c = x; f = y;
+#elif MATRIZ_ROTACION == 90
+	c = y; f = (MATRIZ_FIS_ALTO - 1) - x;
+#elif MATRIZ_ROTACION == 180
+	c = (MATRIZ_FIS_ANCHO - 1) - x; f = (MATRIZ_FIS_ALTO - 1) - y;
+#else
+	c = (MATRIZ_FIS_ANCHO - 1) - y; f = x;
+#endif
+#if MATRIZ_ESPEJO_X
+	c = (MATRIZ_FIS_ANCHO - 1) - c;
+#endif
+#if MATRIZ_ESPEJO_Y
+	f = (MATRIZ_FIS_ALTO - 1) - f;
+#endif
+	if (MATRIZ_FILA_INVERTIDA(f)) c = (MATRIZ_FIS_ANCHO - 1) - c;
+	return (uint16_t)f * MATRIZ_FIS_ANCHO + c;
+}
+
+// ----------------------------------------------------------------------------
+// Tabla en PROGMEM (opcional): MATRIZ_DEFINIR_LUT(nombre) genera
+// const uint8_t nombre[MATRIZ_NUM_LEDS] con el índice lógico de cada LED de la cadena.
+// Sirve para matrices de hasta 256 LEDs; las entradas se calculan al compilar.
+// ----------------------------------------------------------------------------
+#define MATRIZ_L1(p)   MATRIZ_LOGICO(p),
+#define MATRIZ_L4(p)   MATRIZ_L1(p) MATRIZ_L1((p)+1) MATRIZ_L1((p)+2) MATRIZ_L1((p)+3)
+#define MATRIZ_L16(p)  MATRIZ_L4(p) MATRIZ_L4((p)+4) MATRIZ_L4((p)+8) MATRIZ_L4((p)+12)
+#define MATRIZ_L64(p)  MATRIZ_L16(p) MATRIZ_L16((p)+16) MATRIZ_L16((p)+32) MATRIZ_L16((p)+48)
+#define MATRIZ_L256(p) MATRIZ_L64(p) MATRIZ_L64((p)+64) MATRIZ_L64((p)+128) MATRIZ_L64((p)+192)
+
+#if MATRIZ_NUM_LEDS == 64
+#define MATRIZ_DEFINIR_LUT(nombre) const uint8_t nombre[MATRIZ_NUM_LEDS] PROGMEM = { MATRIZ_L64(0) }
+#elif MATRIZ_NUM_LEDS == 256
+#define MATRIZ_DEFINIR_LUT(nombre) const uint8_t nombre[MATRIZ_NUM_LEDS] PROGMEM = { MATRIZ_L256(0) }
+#endif
+
+// ----------------------------------------------------------------------------
+// Seguimiento de cambios del buffer, para no reenviar frames iguales
+// (cada envío a 800 kHz tiene las interrupciones apagadas 30 us por LED)
+//
+// Cada escritura al buffer hace matriz_marcar(); antes de enviar, matriz_hay_cambios() descarta
+// sin mirar el buffer si no hubo escrituras, y si las hubo compara un CRC-16 (CCITT) del buffer
+// con el del último frame enviado (borrar y redibujar lo mismo no cuenta como cambio). El CRC
+// depende de la posición de cada byte: mover un LED encendido siempre cambia el resultado.
+// ----------------------------------------------------------------------------
+typedef struct {
+	uint8_t gen;          // Se incrementa en cada escritura al buffer
+	uint8_t gen_enviada;  // gen al momento del último envío
+	uint16_t hash;        // CRC del último frame enviado
+	uint8_t enviado;      // Ya hubo al menos un envío
+	uint16_t envios;      // Frames enviados
+	uint16_t omitidos;    // Frames que no se enviaron por no tener cambios
+} MatrizCambios;
+
+static inline void matriz_marcar(MatrizCambios *c) {
+	c->gen++;
+}
+
+static inline uint16_t matriz_hash(const uint8_t *p, uint16_t n) {
+	uint16_t h = 0xFFFF;
+	while (n--) h = _crc_ccitt_update(h, *p++);
+	return h;
+}
+
+// 1 si hay que enviar el buffer; registra el envío o la omisión
+static inline uint8_t matriz_hay_cambios(MatrizCambios *c, const void *buf, uint16_t n_bytes) {
+	if (c->enviado && c->gen == c->gen_enviada) { c->omitidos++; return 0; }
+	uint16_t h = matriz_hash((const uint8_t *)buf, n_bytes);
+	c->gen_enviada = c->gen;
+	if (c->enviado && h == c->hash) { c->omitidos++; return 0; }
+	c->hash = h;
+	c->enviado = 1;
+	c->envios++;
+	return 1;
+}
+
+#endif /* MATRIZ_H_ */
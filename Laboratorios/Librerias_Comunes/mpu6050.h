@@ -0,0 +1,326 @@
+// Driver del MPU6050 (compartido por Lab 4 - Problema D y E)
+// Se agrega la carpeta Librerias_Comunes a las rutas de include del proyecto en microchip.
+//
+// Configura frecuencia de muestreo, filtro pasa bajos (DLPF) y escalas, y lee los 14 bytes de
+// datos (acelerómetro, temperatura, giroscopio) en una sola transacción. Dos formas de uso:
+//   MPU_USAR_FIFO 0: el pin INT del sensor (data ready, a PD3 / INT1) dispara la lectura por
+//                    interrupciones de TWI; el programa solo pregunta mpu_hay_dato() y toma la
+//                    muestra con mpu_tomar(). El bus no bloquea al lazo principal.
+//   MPU_USAR_FIFO 1: el sensor guarda las muestras (acelerómetro y giroscopio, 12 bytes) en su
+//                    FIFO de 1024 bytes; el programa las vacía cuando puede con mpu_fifo_cantidad()
+//                    y mpu_fifo_leer(), sin perder muestras aunque el lazo se demore (hasta 85).
+//   MPU_USAR_INT 0:  (sin FIFO) el pin INT no está conectado; el proyecto arranca cada lectura
+//                    llamando a mpu_disparar() desde la interrupción de un timer.
+// Este archivo define las ISR de INT1 y TWI (modo sin FIFO): el proyecto no debe usarlas.
+//
+// Las muestras alimentan un filtro complementario en punto fijo que entrega pitch y roll en
+// centésimas de grado.
+
+#ifndef MPU6050_H_
+#define MPU6050_H_
+
+#ifndef F_CPU
+#define F_CPU 16000000UL
+#endif
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <stdint.h>
+#include <string.h>
+#include <util/atomic.h>
+
+// Configuración (se puede definir antes de incluir)
+#ifndef MPU_DIR
+#define MPU_DIR 0x68          // AD0 a GND
+#endif
+#ifndef MPU_TWI_HZ
+#define MPU_TWI_HZ 400000UL   // El MPU6050 admite modo rápido
+#endif
+#ifndef MPU_FREQ_HZ
+#define MPU_FREQ_HZ 200       // Frecuencia de muestreo (divisor de 1 kHz con el DLPF activo)
+#endif
+#ifndef MPU_DLPF
+#define MPU_DLPF 3            // 1..6: 184, 94, 44, 21, 10, 5 Hz de ancho de banda
+#endif
+#ifndef MPU_GIRO_FS
+#define MPU_GIRO_FS 1         // 0..3: +-250, 500, 1000, 2000 grados/s
+#endif
+#ifndef MPU_USAR_FIFO
+#define MPU_USAR_FIFO 0
+#endif
+#ifndef MPU_USAR_INT
+#define MPU_USAR_INT 1
+#endif
+#ifndef MPU_ALFA
+#define MPU_ALFA 250          // Peso del giroscopio en el filtro, sobre 256 (~0,2 s a 200 Hz)
+#endif
+
+#if MPU_DLPF < 1 || MPU_DLPF > 6
+#error "MPU_DLPF debe ser 1..6 (con el DLPF apagado el giroscopio muestrea a 8 kHz)"
+#endif
+
+// Registros
+#define MPU_SMPLRT_DIV   0x19
+#define MPU_CONFIG       0x1A
+#define MPU_GYRO_CONFIG  0x1B
+#define MPU_ACCEL_CONFIG 0x1C
+#define MPU_FIFO_EN      0x23
+#define MPU_INT_PIN_CFG  0x37
+#define MPU_INT_ENABLE   0x38
+#define MPU_INT_STATUS   0x3A
+#define MPU_ACCEL_XOUT_H 0x3B
+#define MPU_USER_CTRL    0x6A
+#define MPU_PWR_MGMT_1   0x6B
+#define MPU_FIFO_COUNTH  0x72
+#define MPU_FIFO_R_W     0x74
+
+#define MPU_BYTES_MUESTRA 14       // ax, ay, az, temperatura, gx, gy, gz (big endian)
+#define MPU_BYTES_FIFO    12       // En la FIFO: ax, ay, az, gx, gy, gz
+
+// LSB por grado/s (x10) de cada escala, y paso del ángulo por muestra en centésimas de grado
+// * 256 por LSB, también * 256: paso = g * MPU_K_GIRO >> 8
+#define MPU_LSB_GIRO_X10 (MPU_GIRO_FS == 0 ? 1310L : MPU_GIRO_FS == 1 ? 655L : MPU_GIRO_FS == 2 ? 328L : 164L)
+#define MPU_K_GIRO ((int16_t)(65536000L / (MPU_LSB_GIRO_X10 * MPU_FREQ_HZ)))
+
+typedef struct {
+	int16_t ax, ay, az;
+	int16_t temp;
+	int16_t gx, gy, gz;
+} MpuDatos;
+
+// Estadísticas del bus
+volatile uint32_t mpu_bytes = 0;     // Bytes transferidos por I2C (incluye dirección y registro)
+volatile uint16_t mpu_muestras = 0;  // Muestras leídas
+volatile uint16_t mpu_perdidas = 0;  // Data ready con la lectura anterior en curso, o FIFO desbordada
+volatile uint8_t mpu_errores = 0;    // Transacciones sin ACK
+
+// ----------------------------------------------------------------------------
+// Acceso bloqueante (configuración y modo FIFO)
+// ----------------------------------------------------------------------------
+static void mpu_twi_esperar(void) {
+	while (!(TWCR & (1 << TWINT)));
+}
+
+static void mpu_twi_inicio(uint8_t reg) {
+	TWCR = (1 << TWINT) | (1 << TWSTA) | (1 << TWEN); mpu_twi_esperar();
+	TWDR = MPU_DIR << 1; TWCR = (1 << TWINT) | (1 << TWEN); mpu_twi_esperar();
+	TWDR = reg;          TWCR = (1 << TWINT) | (1 << TWEN); mpu_twi_esperar();
+}
+
+static void mpu_escribir(uint8_t reg, uint8_t valor) {
+	mpu_twi_inicio(reg);
+	TWDR = valor; TWCR = (1 << TWINT) | (1 << TWEN); mpu_twi_esperar();
+	TWCR = (1 << TWINT) | (1 << TWSTO) | (1 << TWEN);
+	mpu_bytes += 3;
+}
+
+// Lectura en ráfaga de n bytes desde reg (el sensor autoincrementa el registro, salvo la FIFO)
+static void mpu_leer(uint8_t reg, uint8_t *buf, uint8_t n) {
+	mpu_twi_inicio(reg);
+	TWCR = (1 << TWINT) | (1 << TWSTA) | (1 << TWEN); mpu_twi_esperar();
+	TWDR = (MPU_DIR << 1) | 1; TWCR = (1 << TWINT) | (1 << TWEN); mpu_twi_esperar();
+	for (uint8_t i = 0; i < n; i++) {
+		TWCR = (1 << TWINT) | (1 << TWEN) | ((i < n - 1) ? (1 << TWEA) : 0);
+		mpu_twi_esperar();
+		buf[i] = TWDR;
+	}
+	TWCR = (1 << TWINT) | (1 << TWSTO) | (1 << TWEN);
+	mpu_bytes += 3 + n;
+}
+
+static inline int16_t mpu_be16(const uint8_t *p) {
+	return (int16_t)(((uint16_t)p[0] << 8) | p[1]);
+}
+
+// ----------------------------------------------------------------------------
+// Lectura por interrupciones: INT1 (data ready) o un timer del proyecto arranca la ráfaga y la
+// ISR de TWI la completa
+// ----------------------------------------------------------------------------
+#if !MPU_USAR_FIFO
+static uint8_t mpu_rx[MPU_BYTES_MUESTRA];           // Lo escribe la ISR de TWI
+static uint8_t mpu_ultimo[MPU_BYTES_MUESTRA];       // Última muestra completa
+static volatile uint8_t mpu_idx;
+static volatile uint8_t mpu_ocupado = 0;
+static volatile uint8_t mpu_nuevo = 0;
+
+#define MPU_TWCR_ISR ((1 << TWINT) | (1 << TWEN) | (1 << TWIE))
+
+// Arranca la lectura de una muestra (desde una ISR o con las interrupciones apagadas)
+static inline void mpu_disparar(void) {
+	if (mpu_ocupado) { mpu_perdidas++; return; }
+	mpu_ocupado = 1;
+	mpu_idx = 0;
+	TWCR = MPU_TWCR_ISR | (1 << TWSTA);
+}
+
+#if MPU_USAR_INT
+ISR(INT1_vect) {
+	mpu_disparar();
+}
+#endif
+
+ISR(TWI_vect) {
+	switch (TWSR & 0xF8) {
+	case 0x08: // START
+		TWDR = MPU_DIR << 1;
+		TWCR = MPU_TWCR_ISR;
+		break;
+	case 0x18: // SLA+W con ACK
+		TWDR = MPU_ACCEL_XOUT_H;
+		TWCR = MPU_TWCR_ISR;
+		break;
+	case 0x28: // Registro enviado: repeated start para leer
+		TWCR = MPU_TWCR_ISR | (1 << TWSTA);
+		break;
+	case 0x10: // Repeated START
+		TWDR = (MPU_DIR << 1) | 1;
+		TWCR = MPU_TWCR_ISR;
+		break;
+	case 0x40: // SLA+R con ACK
+		TWCR = MPU_TWCR_ISR | (1 << TWEA);
+		break;
+	case 0x50: // Dato recibido, ACK enviado
+		mpu_rx[mpu_idx++] = TWDR;
+		TWCR = MPU_TWCR_ISR | ((mpu_idx < MPU_BYTES_MUESTRA - 1) ? (1 << TWEA) : 0);
+		break;
+	case 0x58: // Último dato, NACK enviado
+		mpu_rx[mpu_idx] = TWDR;
+		TWCR = (1 << TWINT) | (1 << TWEN) | (1 << TWSTO);
+		memcpy(mpu_ultimo, mpu_rx, MPU_BYTES_MUESTRA);
+		mpu_bytes += 3 + MPU_BYTES_MUESTRA;
+		mpu_muestras++;
+		mpu_nuevo = 1;
+		mpu_ocupado = 0;
+		break;
+	default:   // Sin ACK o arbitraje perdido: se abandona esta muestra
+		TWCR = (1 << TWINT) | (1 << TWEN) | (1 << TWSTO);
+		mpu_errores++;
+		mpu_ocupado = 0;
+		break;
+	}
+}
+
+static inline uint8_t mpu_hay_dato(void) {
+	return mpu_nuevo;
+}
+
+// Copia la última muestra (convertida) y la marca como leída
+static void mpu_tomar(MpuDatos *d) {
+	uint8_t b[MPU_BYTES_MUESTRA];
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		memcpy(b, mpu_ultimo, MPU_BYTES_MUESTRA);
+		mpu_nuevo = 0;
+	}
+	d->ax = mpu_be16(b);     d->ay = mpu_be16(b + 2);  d->az = mpu_be16(b + 4);
+	d->temp = mpu_be16(b + 6);
+	d->gx = mpu_be16(b + 8); d->gy = mpu_be16(b + 10); d->gz = mpu_be16(b + 12);
+}
+#else
+// ----------------------------------------------------------------------------
+// Lectura desde la FIFO (bloqueante, desde el lazo principal)
+// ----------------------------------------------------------------------------
+
+// Muestras completas en la FIFO; si se desbordó la vacía y devuelve 0
+static uint16_t mpu_fifo_cantidad(void) {
+	uint8_t b[2];
+	mpu_leer(MPU_INT_STATUS, b, 1);
+	if (b[0] & 0x10) {                                    // FIFO_OFLOW_INT
+		mpu_escribir(MPU_USER_CTRL, (1 << 6) | (1 << 2)); // FIFO_EN + FIFO_RESET
+		mpu_perdidas++;
+		return 0;
+	}
+	mpu_leer(MPU_FIFO_COUNTH, b, 2);
+	return (((uint16_t)b[0] << 8) | b[1]) / MPU_BYTES_FIFO;
+}
+
+static void mpu_fifo_leer(MpuDatos *d) {
+	uint8_t b[MPU_BYTES_FIFO];
+	mpu_leer(MPU_FIFO_R_W, b, MPU_BYTES_FIFO);
+	d->ax = mpu_be16(b);     d->ay = mpu_be16(b + 2);  d->az = mpu_be16(b + 4);
+	d->temp = 0;
+	d->gx = mpu_be16(b + 6); d->gy = mpu_be16(b + 8);  d->gz = mpu_be16(b + 10);
+	mpu_muestras++;
+}
+#endif
+
+// ----------------------------------------------------------------------------
+// Inicialización
+// ----------------------------------------------------------------------------
+static void mpu_init(void) {
+	TWSR = 0;
+	TWBR = (uint8_t)((F_CPU / MPU_TWI_HZ - 16) / 2);
+	TWCR = (1 << TWEN);
+
+	mpu_escribir(MPU_PWR_MGMT_1, 0x01);                   // Despierta, reloj del PLL del giro X
+	mpu_escribir(MPU_SMPLRT_DIV, 1000 / MPU_FREQ_HZ - 1);
+	mpu_escribir(MPU_CONFIG, MPU_DLPF);
+	mpu_escribir(MPU_GYRO_CONFIG, MPU_GIRO_FS << 3);
+	mpu_escribir(MPU_ACCEL_CONFIG, 0x00);                 // +-2 g: 16384 LSB por g
+#if MPU_USAR_FIFO
+	mpu_escribir(MPU_USER_CTRL, (1 << 2));                // FIFO_RESET
+	mpu_escribir(MPU_FIFO_EN, 0x78);                      // Giro X, Y, Z y acelerómetro
+	mpu_escribir(MPU_USER_CTRL, (1 << 6));                // FIFO_EN
+#elif MPU_USAR_INT
+	mpu_escribir(MPU_INT_PIN_CFG, 0x00);                  // Activo en alto, pulso de 50 us
+	mpu_escribir(MPU_INT_ENABLE, 0x01);                   // DATA_RDY_EN
+	DDRD &= ~(1 << PD3);
+	EICRA = (EICRA & ~((1 << ISC11) | (1 << ISC10))) | (1 << ISC11) | (1 << ISC10); // Flanco de subida
+	EIFR = (1 << INTF1);
+	EIMSK |= (1 << INT1);
+#endif
+}
+
+// ----------------------------------------------------------------------------
+// Filtro complementario en punto fijo: pitch y roll en centésimas de grado
+// El ángulo integra el giroscopio y se corrige hacia el del acelerómetro con peso
+// (256 - MPU_ALFA) / 256 por muestra. Internamente se guarda en centésimas * 256.
+// ----------------------------------------------------------------------------
+typedef struct {
+	int32_t pitch, roll;
+	uint8_t iniciado;
+} FiltroInclinacion;
+
+static uint16_t mpu_raiz(uint32_t v) {
+	uint32_t r = 0, bit = 1UL << 30;
+	while (bit > v) bit >>= 2;
+	while (bit) {
+		if (v >= r + bit) { v -= r + bit; r = (r >> 1) + bit; }
+		else r >>= 1;
+		bit >>= 2;
+	}
+	return (uint16_t)r;
+}
+
+// atan2 en centésimas de grado (error < 0,3 grados): atan(z) ~ 45 z + 15,6 z (1 - z) en [0, 1]
+static int16_t mpu_atan2(int32_t y, int32_t x) {
+	uint32_t ax = (x < 0) ? -x : x;
+	uint32_t ay = (y < 0) ? -y : y;
+	if (!ax && !ay) return 0;
+	uint8_t invertido = ay > ax;
+	uint16_t z = invertido ? (ax << 15) / ay : (ay << 15) / ax; // Q15
+	int16_t a = ((uint32_t)z * (4500 + ((1564UL * (32768 - z)) >> 15))) >> 15;
+	if (invertido) a = 9000 - a;
+	if (x < 0) a = 18000 - a;
+	return (y < 0) ? -a : a;
+}
+
+static void filtro_actualizar(FiltroInclinacion *f, const MpuDatos *d) {
+	int32_t roll_acc = (int32_t)mpu_atan2(d->ay, d->az) << 8;
+	int32_t pitch_acc = (int32_t)mpu_atan2(-(int32_t)d->ax,
+		mpu_raiz((uint32_t)((int32_t)d->ay * d->ay) + (uint32_t)((int32_t)d->az * d->az))) << 8;   // Hasta 2^31
+	if (!f->iniciado) {
+		f->roll = roll_acc;
+		f->pitch = pitch_acc;
+		f->iniciado = 1;
+		return;
+	}
+	f->roll += ((int32_t)d->gx * MPU_K_GIRO) >> 8;
+	f->pitch += ((int32_t)d->gy * MPU_K_GIRO) >> 8;
+	f->roll += ((roll_acc - f->roll) * (256 - MPU_ALFA)) >> 8;
+	f->pitch += ((pitch_acc - f->pitch) * (256 - MPU_ALFA)) >> 8;
+}
+
+static inline int16_t filtro_pitch(const FiltroInclinacion *f) { return f->pitch >> 8; }
+static inline int16_t filtro_roll(const FiltroInclinacion *f) { return f->roll >> 8; }
+
+#endif /* MPU6050_H_ */
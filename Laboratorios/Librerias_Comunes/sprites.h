@@ -0,0 +1,207 @@
+// Sprites 1bpp y texto desplazable sobre buffers Color de las matrices WS2812 (compartido)
+// Antes de incluir este archivo cada proyecto define el tipo Color (campos r, g, b, en el orden
+// que use su envío) e incluye matriz.h con la geometría de su matriz. El buffer es el que se manda
+// tal cual a la cadena: cada pixel lógico (x, y) se escribe en fb[matriz_xy(x, y)].
+//
+// Presupuesto de dibujo en el panel de 256 LEDs: el envío ocupa 7,7 ms de los 16,7 ms de un frame
+// a 60 fps; borrar el buffer (~0,1 ms), el texto (7 filas x 16 columnas) y un sprite de 9x8 quedan
+// por debajo de 1 ms, porque el recorte se calcula una vez por sprite y el desplazamiento se hace
+// corriendo bits de la ventana, sin volver a leer la fuente por cada pixel.
+
+#ifndef SPRITES_H_
+#define SPRITES_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <avr/pgmspace.h>
+
+#ifndef MATRIZ_H_
+#error "Incluir matriz.h antes de sprites.h"
+#endif
+
+#if MATRIZ_ANCHO > 16
+#error "sprites.h usa ventanas de 16 bits: MATRIZ_ANCHO debe ser 16 o menos"
+#endif
+
+// ----------------------------------------------------------------------------
+// Sprites en PROGMEM (hasta 16 de ancho):
+//   ancho, alto, flags, luego alto filas de (ancho + 7) / 8 bytes (MSB = columna izquierda)
+//   y, si flags tiene SPRITE_MASCARA, otra imagen igual con la máscara (1 = pixel opaco).
+// Sin máscara los 1 se pintan con tinta y los 0 son transparentes; con máscara los pixeles
+// opacos se pintan con tinta donde la imagen tiene 1 y con fondo donde tiene 0 (contorno).
+// ----------------------------------------------------------------------------
+#define SPRITE_MASCARA 0x01
+
+// Fila del sprite alineada a la izquierda en 16 bits
+static inline uint16_t sprite_fila(const uint8_t *p, uint8_t bytes) {
+	uint16_t v = (uint16_t)pgm_read_byte(p) << 8;
+	if (bytes > 1) v |= pgm_read_byte(p + 1);
+	return v;
+}
+
+// Mezcla de fondo a tinta en 16 niveles (peso 0 = fondo, 16 = tinta)
+static inline Color color_mezcla(Color fondo, Color tinta, uint8_t peso) {
+	Color c;
+	c.r = fondo.r + (((int16_t)tinta.r - fondo.r) * peso >> 4);
+	c.g = fondo.g + (((int16_t)tinta.g - fondo.g) * peso >> 4);
+	c.b = fondo.b + (((int16_t)tinta.b - fondo.b) * peso >> 4);
+	return c;
+}
+
+// Dibuja el sprite con su esquina superior izquierda en (x, y); puede quedar parcialmente afuera
+static void sprite_dibujar(Color *fb, const uint8_t *spr, int8_t x, int8_t y, Color tinta, Color fondo) {
+	uint8_t ancho = pgm_read_byte(spr);
+	uint8_t alto = pgm_read_byte(spr + 1);
+	uint8_t bytes = (ancho + 7) >> 3;
+	const uint8_t *bits = spr + 3;
+	const uint8_t *mascara = (pgm_read_byte(spr + 2) & SPRITE_MASCARA) ? bits + alto * bytes : NULL;
+
+	// Recorte: parte visible del sprite, una vez por llamada y no por pixel
+	int8_t c0 = (x < 0) ? -x : 0;
+	int8_t c1 = (x + ancho > MATRIZ_ANCHO) ? MATRIZ_ANCHO - x : ancho;
+	int8_t f0 = (y < 0) ? -y : 0;
+	int8_t f1 = (y + alto > MATRIZ_ALTO) ? MATRIZ_ALTO - y : alto;
+	if (c0 >= c1 || f0 >= f1) return;
+
+	for (int8_t f = f0; f < f1; f++) {
+		uint16_t b = sprite_fila(bits + f * bytes, bytes) << c0;
+		uint16_t m = mascara ? sprite_fila(mascara + f * bytes, bytes) << c0 : b;
+		for (int8_t c = c0; c < c1; c++, b <<= 1, m <<= 1) {
+			if (m & 0x8000) fb[matriz_xy(x + c, y + f)] = (b & 0x8000) ? tinta : fondo;
+		}
+	}
+}
+
+// ----------------------------------------------------------------------------
+// Fuente 5x7 en PROGMEM: ' ' a 'Z' (las minúsculas se muestran en mayúscula), 5 bytes por
+// caracter, un byte por columna con el bit 0 en la fila superior. 295 bytes de flash.
+// ----------------------------------------------------------------------------
+#define FUENTE_ANCHO 5
+#define FUENTE_ALTO 7
+#define FUENTE_PASO (FUENTE_ANCHO + 1) // Una columna vacía entre caracteres
+
+static const uint8_t fuente5x7[][FUENTE_ANCHO] PROGMEM = {
+	{0x00,0x00,0x00,0x00,0x00}, {0x00,0x00,0x5F,0x00,0x00}, {0x00,0x07,0x00,0x07,0x00}, // ' ' ! "
+	{0x14,0x7F,0x14,0x7F,0x14}, {0x24,0x2A,0x7F,0x2A,0x12}, {0x23,0x13,0x08,0x64,0x62}, // # $ %
+	{0x36,0x49,0x55,0x22,0x50}, {0x00,0x05,0x03,0x00,0x00}, {0x00,0x1C,0x22,0x41,0x00}, // & ' (
+	{0x00,0x41,0x22,0x1C,0x00}, {0x08,0x2A,0x1C,0x2A,0x08}, {0x08,0x08,0x3E,0x08,0x08}, // ) * +
+	{0x00,0x50,0x30,0x00,0x00}, {0x08,0x08,0x08,0x08,0x08}, {0x00,0x60,0x60,0x00,0x00}, // , - .
+	{0x20,0x10,0x08,0x04,0x02}, {0x3E,0x51,0x49,0x45,0x3E}, {0x00,0x42,0x7F,0x40,0x00}, // / 0 1
+	{0x42,0x61,0x51,0x49,0x46}, {0x21,0x41,0x45,0x4B,0x31}, {0x18,0x14,0x12,0x7F,0x10}, // 2 3 4
+	{0x27,0x45,0x45,0x45,0x39}, {0x3C,0x4A,0x49,0x49,0x30}, {0x01,0x71,0x09,0x05,0x03}, // 5 6 7
+	{0x36,0x49,0x49,0x49,0x36}, {0x06,0x49,0x49,0x29,0x1E}, {0x00,0x36,0x36,0x00,0x00}, // 8 9 :
+	{0x00,0x56,0x36,0x00,0x00}, {0x08,0x14,0x22,0x41,0x00}, {0x14,0x14,0x14,0x14,0x14}, // ; < =
+	{0x00,0x41,0x22,0x14,0x08}, {0x02,0x01,0x51,0x09,0x06}, {0x32,0x49,0x79,0x41,0x3E}, // > ? @
+	{0x7E,0x11,0x11,0x11,0x7E}, {0x7F,0x49,0x49,0x49,0x36}, {0x3E,0x41,0x41,0x41,0x22}, // A B C
+	{0x7F,0x41,0x41,0x22,0x1C}, {0x7F,0x49,0x49,0x49,0x41}, {0x7F,0x09,0x09,0x01,0x01}, // D E F
+	{0x3E,0x41,0x41,0x51,0x32}, {0x7F,0x08,0x08,0x08,0x7F}, {0x00,0x41,0x7F,0x41,0x00}, // G H I
+	{0x20,0x40,0x41,0x3F,0x01}, {0x7F,0x08,0x14,0x22,0x41}, {0x7F,0x40,0x40,0x40,0x40}, // J K L
+	{0x7F,0x02,0x04,0x02,0x7F}, {0x7F,0x04,0x08,0x10,0x7F}, {0x3E,0x41,0x41,0x41,0x3E}, // M N O
+	{0x7F,0x09,0x09,0x09,0x06}, {0x3E,0x41,0x51,0x21,0x5E}, {0x7F,0x09,0x19,0x29,0x46}, // P Q R
+	{0x46,0x49,0x49,0x49,0x31}, {0x01,0x01,0x7F,0x01,0x01}, {0x3F,0x40,0x40,0x40,0x3F}, // S T U
+	{0x1F,0x20,0x40,0x20,0x1F}, {0x7F,0x20,0x18,0x20,0x7F}, {0x63,0x14,0x08,0x14,0x63}, // V W X
+	{0x03,0x04,0x78,0x04,0x03}, {0x61,0x51,0x49,0x45,0x43}                              // Y Z
+};
+
+// Columna i (0..FUENTE_PASO-1) del caracter ch; la última es el espacio entre caracteres
+static inline uint8_t fuente_columna(char ch, uint8_t i) {
+	if (ch >= 'a' && ch <= 'z') ch -= 'a' - 'A';
+	if (ch < ' ' || ch > 'Z') ch = ' ';
+	if (i >= FUENTE_ANCHO) return 0;
+	return pgm_read_byte(&fuente5x7[ch - ' '][i]);
+}
+
+// Dibuja un caracter con su esquina superior izquierda en (x, y), recortado a la matriz
+static void caracter_dibujar(Color *fb, char ch, int8_t x, int8_t y, Color tinta) {
+	int8_t c0 = (x < 0) ? -x : 0;
+	int8_t c1 = (x + FUENTE_ANCHO > MATRIZ_ANCHO) ? MATRIZ_ANCHO - x : FUENTE_ANCHO;
+	int8_t f0 = (y < 0) ? -y : 0;
+	int8_t f1 = (y + FUENTE_ALTO > MATRIZ_ALTO) ? MATRIZ_ALTO - y : FUENTE_ALTO;
+	for (int8_t c = c0; c < c1; c++) {
+		uint8_t col = fuente_columna(ch, c) >> f0;
+		for (int8_t f = f0; f < f1; f++, col >>= 1) {
+			if (col & 1) fb[matriz_xy(x + c, y + f)] = tinta;
+		}
+	}
+}
+
+// ----------------------------------------------------------------------------
+// Texto desplazable: la parte visible del mensaje se guarda como una ventana de 1 bit por pixel
+// (un uint16_t por fila, bit 15 = columna 0). Avanzar una columna es correr cada fila un bit y
+// meter por la derecha la columna siguiente de la fuente. La posición tiene 4 bits de fracción:
+// entre dos desplazamientos cada pixel se dibuja mezclando su columna con la que va a ocupar su
+// lugar, así el texto avanza suave aunque la velocidad sea una fracción de columna por frame.
+// ----------------------------------------------------------------------------
+#define SCROLL_ENTRADA (0x8000u >> (MATRIZ_ANCHO - 1)) // Bit de la columna derecha de la matriz
+
+typedef struct {
+	const char *texto;            // Mensaje en PROGMEM, terminado en 0 (no vacío)
+	const char *car;              // Caracter que está entrando por la derecha
+	uint8_t sub;                  // Columna de ese caracter (0..FUENTE_PASO-1)
+	uint8_t blancos;              // Columnas vacías pendientes antes de repetir el mensaje
+	uint8_t siguiente;            // Columna que entra en el próximo desplazamiento
+	uint8_t fraccion;             // Posición entre columnas, en 1/16
+	uint8_t velocidad;            // Avance por frame, en 1/16 de columna
+	uint16_t filas[FUENTE_ALTO];  // Ventana visible
+} Scroll;
+
+// Próxima columna del mensaje; al terminar deja pasar una pantalla vacía y vuelve a empezar
+static uint8_t scroll_columna(Scroll *s) {
+	if (s->blancos) {
+		if (--s->blancos == 0) s->car = s->texto;
+		return 0;
+	}
+	uint8_t col = fuente_columna(pgm_read_byte(s->car), s->sub);
+	if (++s->sub == FUENTE_PASO) {
+		s->sub = 0;
+		s->car++;
+		if (!pgm_read_byte(s->car)) s->blancos = MATRIZ_ANCHO;
+	}
+	return col;
+}
+
+static void scroll_iniciar(Scroll *s, const char *texto, uint8_t velocidad) {
+	s->texto = s->car = texto;
+	s->sub = 0;
+	s->blancos = 0;
+	s->fraccion = 0;
+	s->velocidad = velocidad;
+	for (uint8_t f = 0; f < FUENTE_ALTO; f++) s->filas[f] = 0;
+	s->siguiente = scroll_columna(s);
+}
+
+// Avanza la posición de un frame
+static void scroll_avanzar(Scroll *s) {
+	s->fraccion += s->velocidad;
+	while (s->fraccion >= 16) {
+		s->fraccion -= 16;
+		uint8_t col = s->siguiente;
+		for (uint8_t f = 0; f < FUENTE_ALTO; f++, col >>= 1) {
+			s->filas[f] = (s->filas[f] << 1) | ((col & 1) ? SCROLL_ENTRADA : 0);
+		}
+		s->siguiente = scroll_columna(s);
+	}
+}
+
+// Dibuja la franja del texto (FUENTE_ALTO filas a partir de y, de lado a lado, opaca)
+static void scroll_dibujar(Color *fb, const Scroll *s, int8_t y, Color tinta, Color fondo) {
+	// Solo hay 4 combinaciones (columna actual, columna que llega): sus colores se calculan por frame
+	Color nivel[4];
+	nivel[0] = fondo;
+	nivel[1] = color_mezcla(fondo, tinta, s->fraccion);      // Pixel que se está encendiendo
+	nivel[2] = color_mezcla(fondo, tinta, 16 - s->fraccion); // Pixel que se está apagando
+	nivel[3] = tinta;
+
+	uint8_t col = s->siguiente;
+	for (uint8_t f = 0; f < FUENTE_ALTO; f++, col >>= 1) {
+		int8_t fila = y + f;
+		if (fila < 0 || fila >= MATRIZ_ALTO) continue;
+		uint16_t actual = s->filas[f];
+		uint16_t luego = (actual << 1) | ((col & 1) ? SCROLL_ENTRADA : 0);
+		for (uint8_t x = 0; x < MATRIZ_ANCHO; x++, actual <<= 1, luego <<= 1) {
+			fb[matriz_xy(x, fila)] = nivel[((actual >> 14) & 2) | (luego >> 15)];
+		}
+	}
+}
+
+#endif /* SPRITES_H_ */
@@ -0,0 +1,206 @@
+// Base de tiempo compartida: micros() y millis() de 32 bits (Lab 4 - Problema A, B, D y E)
+// Se agrega la carpeta Librerias_Comunes a las rutas de include del proyecto en microchip.
+//
+// Un timer de 8 bits (Timer0 o Timer2) corre libre; su ISR de desborde acumula milisegundos y
+// una fracción en unidades de 8 us, y micros() suma la cuenta actual del timer. El timer puede
+// seguir generando PWM mientras su TOP sea 0xFF (modo normal o fast PWM, WGM2 = 0): tiempo_init()
+// solo toca el prescaler y la interrupción de desborde.
+//   TIEMPO_PRESCALER 64:  resolución 4 us, un desborde cada 1,024 ms
+//   TIEMPO_PRESCALER 256: resolución 16 us, un desborde cada 4,096 ms. Conviene si el programa
+//                         apaga las interrupciones más de 1 ms seguido (envíos WS2812 de 64 LEDs o
+//                         más), porque un desborde no atendido antes del siguiente se pierde.
+// Este archivo define la ISR de desborde del timer elegido: el proyecto no debe usarla.
+//
+// En proyectos de varios archivos, uno solo incluye tiempo.h tal cual (define variables, ISR y
+// funciones) y los demás definen TIEMPO_SOLO_DECLARAR antes de incluirlo.
+//
+// Los tiempos se comparan siempre por diferencia (tiempo_vencido, tiempo_cada), así que siguen
+// andando cuando micros() da la vuelta (71,6 minutos) o millis() (49,7 días).
+
+#ifndef TIEMPO_H_
+#define TIEMPO_H_
+
+#ifndef F_CPU
+#define F_CPU 16000000UL
+#endif
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <stdint.h>
+#include <util/atomic.h>
+#include <util/delay_basic.h>
+
+// Configuración (se puede definir antes de incluir)
+#ifndef TIEMPO_TIMER
+#define TIEMPO_TIMER 0
+#endif
+#ifndef TIEMPO_PRESCALER
+#define TIEMPO_PRESCALER 64
+#endif
+
+#if F_CPU != 16000000UL
+#error "tiempo.h está calculado para F_CPU = 16 MHz"
+#endif
+
+#if TIEMPO_PRESCALER == 64
+#define TIEMPO_US_POR_CUENTA     4
+#define TIEMPO_MS_POR_DESBORDE   1   // 1024 us = 1 ms + 24 us
+#define TIEMPO_FRAC_POR_DESBORDE 3   // 24 us en unidades de 8 us
+#elif TIEMPO_PRESCALER == 256
+#define TIEMPO_US_POR_CUENTA     16
+#define TIEMPO_MS_POR_DESBORDE   4   // 4096 us = 4 ms + 96 us
+#define TIEMPO_FRAC_POR_DESBORDE 12
+#else
+#error "TIEMPO_PRESCALER debe ser 64 o 256"
+#endif
+#define TIEMPO_FRAC_POR_MS 125       // 1 ms = 125 * 8 us
+
+#if TIEMPO_TIMER == 0
+#define TIEMPO_TCNT   TCNT0
+#define TIEMPO_TCCRB  TCCR0B
+#define TIEMPO_TIFR   TIFR0
+#define TIEMPO_TOV    TOV0
+#define TIEMPO_TIMSK  TIMSK0
+#define TIEMPO_TOIE   TOIE0
+#define TIEMPO_VECT   TIMER0_OVF_vect
+#define TIEMPO_CS     (TIEMPO_PRESCALER == 64 ? ((1 << CS01) | (1 << CS00)) : (1 << CS02))
+#elif TIEMPO_TIMER == 2
+#define TIEMPO_TCNT   TCNT2
+#define TIEMPO_TCCRB  TCCR2B
+#define TIEMPO_TIFR   TIFR2
+#define TIEMPO_TOV    TOV2
+#define TIEMPO_TIMSK  TIMSK2
+#define TIEMPO_TOIE   TOIE2
+#define TIEMPO_VECT   TIMER2_OVF_vect
+#define TIEMPO_CS     (TIEMPO_PRESCALER == 64 ? (1 << CS22) : ((1 << CS22) | (1 << CS21)))
+#else
+#error "TIEMPO_TIMER debe ser 0 o 2"
+#endif
+#define TIEMPO_CS_MASCARA 0x07
+
+#ifdef TIEMPO_SOLO_DECLARAR
+
+extern volatile uint32_t tiempo_ms;
+extern volatile uint8_t tiempo_fraccion;
+void tiempo_init(void);
+uint32_t micros(void);
+uint32_t millis(void);
+uint8_t tiempo_medir_isr(void);
+
+#else
+
+volatile uint32_t tiempo_ms = 0;
+volatile uint8_t tiempo_fraccion = 0; // Resto en unidades de 8 us (0..124)
+
+ISR(TIEMPO_VECT) {
+	// Copias locales: cada volatile se lee y escribe una sola vez
+	uint32_t m = tiempo_ms + TIEMPO_MS_POR_DESBORDE;
+	uint8_t f = tiempo_fraccion + TIEMPO_FRAC_POR_DESBORDE;
+	if (f >= TIEMPO_FRAC_POR_MS) {
+		f -= TIEMPO_FRAC_POR_MS;
+		m++;
+	}
+	tiempo_fraccion = f;
+	tiempo_ms = m;
+}
+
+void tiempo_init(void) {
+	// Conserva el modo (WGM) y las salidas (COM) por si el timer también hace PWM
+	TIEMPO_TCCRB = (TIEMPO_TCCRB & ~TIEMPO_CS_MASCARA) | TIEMPO_CS;
+	TIEMPO_TIFR = (1 << TIEMPO_TOV);
+	TIEMPO_TIMSK |= (1 << TIEMPO_TOIE);
+}
+
+// Milisegundos desde tiempo_init(). Avanza de a TIEMPO_MS_POR_DESBORDE (o uno más);
+// para medir intervalos cortos usar micros().
+uint32_t millis(void) {
+	uint32_t m;
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		m = tiempo_ms;
+	}
+	return m;
+}
+
+// Microsegundos desde tiempo_init(), con la resolución de una cuenta del timer
+uint32_t micros(void) {
+	uint32_t m;
+	uint8_t f, t, pendiente;
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		m = tiempo_ms;
+		f = tiempo_fraccion;
+		t = TIEMPO_TCNT;
+		// Desbordó pero la ISR todavía no corrió (interrupciones apagadas): se cuenta acá.
+		// Con t == 255 la bandera pudo subir después de leer TCNT, y ese desborde no va.
+		pendiente = (TIEMPO_TIFR & (1 << TIEMPO_TOV)) && t != 255;
+	}
+	if (pendiente) {
+		m += TIEMPO_MS_POR_DESBORDE;
+		f += TIEMPO_FRAC_POR_DESBORDE;
+		if (f >= TIEMPO_FRAC_POR_MS) {
+			f -= TIEMPO_FRAC_POR_MS;
+			m++;
+		}
+	}
+	return m * 1000 + (uint16_t)f * 8 + (uint16_t)t * TIEMPO_US_POR_CUENTA;
+}
+
+// Costo de la ISR de desborde en ciclos, entrada y salida incluidas. Pone el timer un momento
+// con prescaler 1 (TCNT cuenta ciclos) y compara un mismo lazo de espera corrido sin la ISR y
+// con un desborde forzado en el medio; se queda con el mínimo de varias pasadas por si otra
+// interrupción se cuela. Deja el timer y los contadores como estaban (dura ~60 us).
+uint8_t tiempo_medir_isr(void) {
+	uint8_t minimo = 255;
+	uint8_t sreg = SREG;
+	cli();
+	uint8_t tccrb = TIEMPO_TCCRB;
+	uint8_t tcnt = TIEMPO_TCNT;
+	uint32_t ms = tiempo_ms;
+	uint8_t frac = tiempo_fraccion;
+
+	TIEMPO_TCCRB = (tccrb & ~TIEMPO_CS_MASCARA) | 1;
+	for (uint8_t i = 0; i < 4; i++) {
+		TIEMPO_TCNT = 0;
+		_delay_loop_1(40);                 // 120 ciclos
+		uint8_t sin_isr = TIEMPO_TCNT;
+
+		TIEMPO_TCNT = 256 - 60;            // Desborda a mitad del lazo
+		TIEMPO_TIFR = (1 << TIEMPO_TOV);
+		sei();
+		_delay_loop_1(40);
+		cli();
+		uint8_t con_isr = TIEMPO_TCNT + 60; // Ciclos desde la carga, contando el desborde
+
+		uint8_t costo = con_isr - sin_isr - 2; // sei y cli
+		if (costo < minimo) minimo = costo;
+	}
+
+	TIEMPO_TCCRB = tccrb;
+	TIEMPO_TCNT = tcnt;
+	TIEMPO_TIFR = (1 << TIEMPO_TOV);
+	tiempo_ms = ms;
+	tiempo_fraccion = frac;
+	SREG = sreg;
+	return minimo;
+}
+
+#endif /* TIEMPO_SOLO_DECLARAR */
+
+// ----------------------------------------------------------------------------
+// Plazos. "ahora" viene de micros() o millis(); las diferencias deben ser menores a 2^31.
+// ----------------------------------------------------------------------------
+
+// 1 si ya se llegó a "limite"
+static inline uint8_t tiempo_vencido(uint32_t ahora, uint32_t limite) {
+	return (int32_t)(ahora - limite) >= 0;
+}
+
+// Tarea periódica sin deriva: si venció corre el límite un período y devuelve 1.
+// Si el lazo se atrasó más de un período no intenta recuperar las vueltas perdidas.
+static inline uint8_t tiempo_cada(uint32_t *limite, uint32_t periodo, uint32_t ahora) {
+	if (!tiempo_vencido(ahora, *limite)) return 0;
+	*limite += periodo;
+	if (tiempo_vencido(ahora, *limite)) *limite = ahora + periodo;
+	return 1;
+}
+
+#endif /* TIEMPO_H_ */
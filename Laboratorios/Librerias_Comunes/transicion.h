@@ -0,0 +1,60 @@
+// Transiciones entre frames de las matrices WS2812: fundido, cortina y deslizamiento (compartido)
+// Antes de incluir este archivo cada proyecto incluye matriz.h con la geometría de su matriz.
+//
+// No se arma un segundo buffer RGB: el proyecto recorre la cadena al transmitir y, para cada
+// pixel lógico (x, y), pide a transicion_pixel() de qué columna leer el frame saliente y el
+// entrante y con qué peso mezclarlos; los dos frames se decodifican de PROGMEM en ese momento.
+// El estado de la transición ocupa 2 bytes de RAM.
+
+#ifndef TRANSICION_H_
+#define TRANSICION_H_
+
+#include <stdint.h>
+
+#ifndef MATRIZ_H_
+#error "Incluir matriz.h antes de transicion.h"
+#endif
+
+#define TRANS_NINGUNA  0 // Corte directo
+#define TRANS_FUNDIDO  1 // Mezcla de todos los pixeles a la vez
+#define TRANS_CORTINA  2 // El frame nuevo avanza de izquierda a derecha con borde suave
+#define TRANS_DESLIZAR 3 // El frame nuevo entra por la derecha empujando al anterior
+#define TRANS_CANTIDAD 4
+
+typedef struct {
+	uint8_t tipo;
+	uint8_t progreso; // 0 = solo el frame saliente, 255 = solo el entrante
+} Transicion;
+
+// Qué mostrar en un pixel: columna del frame saliente, columna del entrante y peso del entrante
+typedef struct {
+	uint8_t x_sal;
+	uint8_t x_ent;
+	uint8_t peso;
+} MuestraTransicion;
+
+// Interpolación lineal en punto fijo de 8 bits: t = 0 da a, t = 255 da b exacto
+static inline uint8_t mezcla8(uint8_t a, uint8_t b, uint8_t t) {
+	if (b >= a) return a + (((uint16_t)(b - a) * (t + 1)) >> 8);
+	return a - (((uint16_t)(a - b) * (t + 1)) >> 8);
+}
+
+static inline MuestraTransicion transicion_pixel(const Transicion *t, uint8_t x) {
+	MuestraTransicion m;
+	m.x_sal = x;
+	m.x_ent = x;
+	if (t->tipo == TRANS_CORTINA) {
+		// Borde en progreso * (ancho + 1) / 256 pixeles; el pixel del borde queda a medias
+		int16_t p = (int16_t)t->progreso * (MATRIZ_ANCHO + 1) - ((int16_t)x << 8);
+		m.peso = (p <= 0) ? 0 : (p >= 255) ? 255 : (uint8_t)p;
+	} else if (t->tipo == TRANS_DESLIZAR) {
+		uint8_t s = x + (((uint16_t)t->progreso * (MATRIZ_ANCHO + 1)) >> 8);
+		if (s < MATRIZ_ANCHO) { m.x_sal = s; m.peso = 0; }
+		else { m.x_ent = s - MATRIZ_ANCHO; m.peso = 255; }
+	} else {
+		m.peso = t->progreso;
+	}
+	return m;
+}
+
+#endif /* TRANSICION_H_ */
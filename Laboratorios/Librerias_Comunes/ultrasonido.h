@@ -0,0 +1,175 @@
+// Medición de distancia con el HC-SR04 por interrupciones (compartido por Lab 4 - Problema E y Ev14)
+// Se agrega la carpeta Librerias_Comunes a las rutas de include del proyecto en microchip.
+//
+// El Timer1 corre con 0,5 us por cuenta y un período de 20 ms (prescaler 8, TOP = ICR1 = 39999,
+// la configuración del servo; us_timer1_init() la arma si el proyecto no usa el Timer1). Cada
+// US_PERIODOS_DISPARO desbordes la ISR del Timer1 dispara el sensor, y la interrupción por cambio
+// de pin del eco guarda la cuenta del timer en cada flanco. Con el flanco de bajada se calcula la
+// distancia en mm (enteros) y se pasa por una mediana de las últimas US_MUESTRAS mediciones; el
+// programa solo lee el último valor con us_distancia_mm(), nunca espera al sensor.
+//
+// El pin de eco se lee por cambio de pin (no por captura), así que un flanco que llega con las
+// interrupciones apagadas se fecha tarde: quien apague las interrupciones mucho tiempo (envíos
+// WS2812) llama antes a us_descartar() y esa medición no se usa.
+// Este archivo define las ISR de desborde del Timer1 y del grupo de cambio de pin del eco.
+
+#ifndef ULTRASONIDO_H_
+#define ULTRASONIDO_H_
+
+#ifndef F_CPU
+#define F_CPU 16000000UL
+#endif
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <stdint.h>
+#include <util/atomic.h>
+#include <util/delay.h>
+
+#if F_CPU != 16000000UL
+#error "ultrasonido.h cuenta el Timer1 con prescaler 8 a 16 MHz"
+#endif
+
+// Configuración (se puede definir antes de incluir)
+#ifndef US_TRIG_BIT
+#define US_TRIG_PORT PORTB
+#define US_TRIG_DDR  DDRB
+#define US_TRIG_BIT  PB0
+#endif
+#ifndef US_ECHO_BIT
+#define US_ECHO_PIN  PIND
+#define US_ECHO_DDR  DDRD
+#define US_ECHO_BIT  PD6
+#endif
+#ifndef US_ECHO_PCMSK
+#define US_ECHO_PCMSK PCMSK2      // Grupo de cambio de pin del puerto del eco (el bit es el mismo)
+#define US_ECHO_PCIE  PCIE2
+#define US_ECHO_VECT  PCINT2_vect
+#endif
+#ifndef US_MAX_MM
+#define US_MAX_MM 2000            // Más lejos cuenta como fuera de rango
+#endif
+#ifndef US_MUESTRAS
+#define US_MUESTRAS 5             // Mediana de las últimas N (impar)
+#endif
+#ifndef US_PERIODOS_DISPARO
+#define US_PERIODOS_DISPARO 3     // Un disparo cada 60 ms (el eco sin obstáculo dura hasta 38 ms)
+#endif
+
+#if US_MUESTRAS % 2 == 0 || US_MUESTRAS > 9
+#error "US_MUESTRAS debe ser impar y no mayor a 9"
+#endif
+
+#define US_CUENTAS_PERIODO 40000UL
+#define US_FUERA_DE_RANGO 0xFFFF
+// mm = cuentas * 0,5 us * 0,1715 mm/us (343 m/s, ida y vuelta) = cuentas * 5620 / 65536
+#define US_MM_POR_CUENTA_Q16 5620UL
+
+#define US_LIBRE      0
+#define US_DISPARADO  1   // Esperando el flanco de subida
+#define US_ECO        2   // Esperando el flanco de bajada
+#define US_DESCARTAR  3   // Hubo interrupciones apagadas durante la medición
+
+static volatile uint8_t us_estado = US_LIBRE;
+static volatile uint16_t us_distancia = US_FUERA_DE_RANGO;  // Mediana, en mm
+static volatile uint16_t us_descartadas = 0;
+static uint8_t us_periodo = 0;           // Desbordes del Timer1 desde el último disparo
+static uint32_t us_inicio;               // Cuentas del disparo al flanco de subida
+static uint16_t us_muestras[US_MUESTRAS];
+static uint8_t us_pos = 0;
+
+// Timer1 solo como base de tiempo: modo 14 (fast PWM, TOP = ICR1), sin salidas
+static void us_timer1_init(void) {
+	TCCR1A = (1 << WGM11);
+	TCCR1B = (1 << WGM13) | (1 << WGM12) | (1 << CS11);
+	ICR1 = US_CUENTAS_PERIODO - 1;
+}
+
+static void us_init(void) {
+	for (uint8_t i = 0; i < US_MUESTRAS; i++) us_muestras[i] = US_FUERA_DE_RANGO;
+	US_TRIG_DDR |= (1 << US_TRIG_BIT);
+	US_TRIG_PORT &= ~(1 << US_TRIG_BIT);
+	US_ECHO_DDR &= ~(1 << US_ECHO_BIT);
+	US_ECHO_PCMSK |= (1 << US_ECHO_BIT);
+	PCICR |= (1 << US_ECHO_PCIE);
+	TIMSK1 |= (1 << TOIE1);
+}
+
+// Cuentas del Timer1 desde el disparo (desde las ISR, con las interrupciones apagadas)
+static inline uint32_t us_cuentas(void) {
+	uint16_t t = TCNT1;
+	uint8_t p = us_periodo;
+	// Desbordó pero la ISR todavía no corrió
+	if ((TIFR1 & (1 << TOV1)) && t < US_CUENTAS_PERIODO / 2) p++;
+	return (uint32_t)p * US_CUENTAS_PERIODO + t;
+}
+
+// Agrega una medición y recalcula la mediana (inserción: a lo sumo 10 comparaciones con 5)
+static void us_agregar(uint16_t mm) {
+	uint16_t orden[US_MUESTRAS];
+	us_muestras[us_pos] = mm;
+	if (++us_pos >= US_MUESTRAS) us_pos = 0;
+	for (uint8_t i = 0; i < US_MUESTRAS; i++) {
+		uint16_t v = us_muestras[i];
+		uint8_t j = i;
+		while (j > 0 && orden[j - 1] > v) {
+			orden[j] = orden[j - 1];
+			j--;
+		}
+		orden[j] = v;
+	}
+	us_distancia = orden[US_MUESTRAS / 2];
+}
+
+ISR(TIMER1_OVF_vect) {
+	if (++us_periodo < US_PERIODOS_DISPARO) return;
+	us_periodo = 0;
+	// La medición anterior no terminó: sin eco, o eco más largo que el período
+	if (us_estado == US_DISPARADO || us_estado == US_ECO) us_agregar(US_FUERA_DE_RANGO);
+	else if (us_estado == US_DESCARTAR) us_descartadas++;
+	us_estado = US_DISPARADO;
+	US_TRIG_PORT |= (1 << US_TRIG_BIT);
+	_delay_us(10);
+	US_TRIG_PORT &= ~(1 << US_TRIG_BIT);
+}
+
+ISR(US_ECHO_VECT) {
+	uint32_t t = us_cuentas();
+	if (US_ECHO_PIN & (1 << US_ECHO_BIT)) {
+		if (us_estado == US_DISPARADO) {
+			us_inicio = t;
+			us_estado = US_ECO;
+		}
+	} else if (us_estado == US_ECO) {
+		uint32_t mm = ((t - us_inicio) * US_MM_POR_CUENTA_Q16) >> 16;
+		us_agregar(mm > US_MAX_MM ? US_FUERA_DE_RANGO : (uint16_t)mm);
+		us_estado = US_LIBRE;
+	} else if (us_estado == US_DESCARTAR) {
+		us_descartadas++;
+		us_estado = US_LIBRE;
+	}
+}
+
+// Última distancia filtrada en mm (US_FUERA_DE_RANGO si no hay obstáculo dentro de US_MAX_MM)
+static inline uint16_t us_distancia_mm(void) {
+	uint16_t d;
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		d = us_distancia;
+	}
+	return d;
+}
+
+// 1 entre el disparo y el fin del eco
+static inline uint8_t us_midiendo(void) {
+	uint8_t e = us_estado;
+	return e == US_DISPARADO || e == US_ECO;
+}
+
+// Anula la medición en curso (llamar antes de apagar las interrupciones por mucho tiempo)
+static inline void us_descartar(void) {
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		if (us_midiendo()) us_estado = US_DESCARTAR;
+	}
+}
+
+#endif /* ULTRASONIDO_H_ */
@@ -0,0 +1,127 @@
+// Etapa de salida para WS2812: gamma, brillo global, dithering temporal y límite de corriente
+// (Lab 4 - Problema C y E). Se llama una vez por byte dentro del bucle de envío de cada proyecto,
+// así no hace falta otra pasada sobre el buffer:
+//
+//   cli();
+//   for (cada LED) { ws2812_byte(salida_canal(g)); ws2812_byte(salida_canal(r)); ws2812_byte(salida_canal(b)); }
+//   sei();
+//   salida_fin_frame();
+//
+// Configuración (antes de incluir):
+//   SALIDA_NUM_LEDS      cantidad de LEDs (para el consumo en reposo)
+//   SALIDA_LIMITE_MA     presupuesto de corriente de la fuente en mA
+//   SALIDA_MA_POR_CANAL  corriente de un canal a PWM máximo (WS2812B: ~20 mA)
+//   SALIDA_MA_REPOSO     consumo de cada LED apagado (~1 mA)
+//   SALIDA_DITHER        1 para activar el dithering temporal (requiere refrescar la matriz seguido)
+//
+// El límite de corriente usa la suma del frame anterior: el brillo efectivo de un frame se calcula
+// al terminar de enviar el previo. Si el contenido se refresca cada pocos ms, un frame nuevo muy
+// brillante se pasa del presupuesto como mucho durante un refresco.
+
+#ifndef WS2812_SALIDA_H_
+#define WS2812_SALIDA_H_
+
+#include <stdint.h>
+#include <avr/pgmspace.h>
+
+#ifndef SALIDA_NUM_LEDS
+#error "Definir SALIDA_NUM_LEDS antes de incluir ws2812_salida.h"
+#endif
+#ifndef SALIDA_LIMITE_MA
+#define SALIDA_LIMITE_MA 2000
+#endif
+#ifndef SALIDA_MA_POR_CANAL
+#define SALIDA_MA_POR_CANAL 20
+#endif
+#ifndef SALIDA_MA_REPOSO
+#define SALIDA_MA_REPOSO 1
+#endif
+#ifndef SALIDA_DITHER
+#define SALIDA_DITHER 1
+#endif
+
+// Gamma 2.6 en punto fijo 8.8: salida_gamma[v] = 255 * (v/255)^2.6 * 256
+const uint16_t salida_gamma[256] PROGMEM = {
+	0x0000, 0x0000, 0x0000, 0x0001, 0x0001, 0x0002, 0x0004, 0x0006,
+	0x0008, 0x000B, 0x000E, 0x0012, 0x0017, 0x001C, 0x0022, 0x0029,
+	0x0031, 0x0039, 0x0042, 0x004C, 0x0057, 0x0063, 0x0070, 0x007D,
+	0x008C, 0x009C, 0x00AC, 0x00BE, 0x00D1, 0x00E5, 0x00FA, 0x0110,
+	0x0128, 0x0141, 0x015A, 0x0176, 0x0192, 0x01B0, 0x01CF, 0x01EF,
+	0x0211, 0x0234, 0x0258, 0x027E, 0x02A5, 0x02CE, 0x02F8, 0x0324,
+	0x0351, 0x0380, 0x03B0, 0x03E2, 0x0416, 0x044B, 0x0481, 0x04BA,
+	0x04F4, 0x0530, 0x056D, 0x05AC, 0x05ED, 0x0630, 0x0674, 0x06BA,
+	0x0702, 0x074C, 0x0798, 0x07E5, 0x0834, 0x0886, 0x08D9, 0x092E,
+	0x0985, 0x09DE, 0x0A39, 0x0A96, 0x0AF5, 0x0B56, 0x0BB9, 0x0C1E,
+	0x0C85, 0x0CEE, 0x0D59, 0x0DC7, 0x0E36, 0x0EA8, 0x0F1C, 0x0F92,
+	0x100A, 0x1085, 0x1101, 0x1180, 0x1201, 0x1285, 0x130A, 0x1392,
+	0x141D, 0x14A9, 0x1538, 0x15C9, 0x165D, 0x16F3, 0x178B, 0x1826,
+	0x18C4, 0x1963, 0x1A05, 0x1AAA, 0x1B51, 0x1BFB, 0x1CA7, 0x1D56,
+	0x1E07, 0x1EBA, 0x1F71, 0x202A, 0x20E5, 0x21A3, 0x2264, 0x2327,
+	0x23ED, 0x24B6, 0x2581, 0x264F, 0x271F, 0x27F3, 0x28C9, 0x29A2,
+	0x2A7D, 0x2B5C, 0x2C3D, 0x2D21, 0x2E07, 0x2EF1, 0x2FDD, 0x30CC,
+	0x31BE, 0x32B3, 0x33AB, 0x34A6, 0x35A3, 0x36A4, 0x37A7, 0x38AD,
+	0x39B7, 0x3AC3, 0x3BD2, 0x3CE4, 0x3DFA, 0x3F12, 0x402D, 0x414B,
+	0x426D, 0x4391, 0x44B9, 0x45E3, 0x4711, 0x4842, 0x4975, 0x4AAC,
+	0x4BE7, 0x4D24, 0x4E64, 0x4FA8, 0x50EF, 0x5239, 0x5386, 0x54D7,
+	0x562B, 0x5782, 0x58DC, 0x5A3A, 0x5B9A, 0x5CFE, 0x5E66, 0x5FD1,
+	0x613F, 0x62B0, 0x6425, 0x659D, 0x6719, 0x6898, 0x6A1A, 0x6BA0,
+	0x6D29, 0x6EB5, 0x7045, 0x71D9, 0x7370, 0x750A, 0x76A8, 0x784A,
+	0x79EF, 0x7B97, 0x7D43, 0x7EF3, 0x80A6, 0x825C, 0x8417, 0x85D4,
+	0x8796, 0x895B, 0x8B24, 0x8CF0, 0x8EC0, 0x9093, 0x926B, 0x9446,
+	0x9624, 0x9806, 0x99ED, 0x9BD6, 0x9DC4, 0x9FB5, 0xA1AA, 0xA3A3,
+	0xA59F, 0xA79F, 0xA9A3, 0xABAB, 0xADB7, 0xAFC6, 0xB1DA, 0xB3F1,
+	0xB60C, 0xB82B, 0xBA4D, 0xBC74, 0xBE9E, 0xC0CD, 0xC2FF, 0xC536,
+	0xC770, 0xC9AE, 0xCBF0, 0xCE36, 0xD080, 0xD2CE, 0xD520, 0xD776,
+	0xD9D0, 0xDC2E, 0xDE90, 0xE0F7, 0xE361, 0xE5CF, 0xE842, 0xEAB8,
+	0xED33, 0xEFB1, 0xF234, 0xF4BB, 0xF746, 0xF9D5, 0xFC68, 0xFF00,
+};
+
+static uint8_t salida_brillo = 255;   // Brillo global pedido (0-255)
+static uint8_t salida_escala = 255;   // Brillo efectivo del frame en curso (con el límite aplicado)
+static uint8_t salida_umbral = 0;     // Umbral de dither del frame en curso
+static uint8_t salida_ruido = 0;      // Desplazamiento por canal para que los LEDs no parpadeen juntos
+static uint8_t salida_frame = 0;
+static uint32_t salida_suma = 0;      // Suma del PWM lineal a brillo máximo (estimación de corriente)
+static uint16_t salida_ma = 0;        // Corriente estimada del último frame enviado
+
+// Gamma + brillo + dither de un canal. Brillo: (g * escala) >> 8 con dos productos 8x8.
+static inline __attribute__((always_inline)) uint8_t salida_canal(uint8_t v) {
+	uint16_t g = pgm_read_word(&salida_gamma[v]);
+	uint8_t alto = g >> 8, bajo = (uint8_t)g;
+	salida_suma += alto;
+	uint16_t s = (uint16_t)alto * salida_escala + (((uint16_t)bajo * salida_escala) >> 8);
+#if SALIDA_DITHER
+	// La parte fraccionaria decide, frame a frame, si se redondea para arriba
+	salida_ruido += 0x4F;
+	s += (uint8_t)(salida_umbral + salida_ruido);
+#endif
+	return s >> 8;
+}
+
+// Al terminar cada envío: corriente del frame, brillo permitido para el siguiente y nuevo umbral
+static inline void salida_fin_frame(void) {
+	const uint16_t reposo = (uint16_t)SALIDA_NUM_LEDS * SALIDA_MA_REPOSO;
+	const uint16_t disponible = SALIDA_LIMITE_MA - reposo;
+	uint32_t demanda = salida_suma * SALIDA_MA_POR_CANAL / 255;    // mA a brillo 255
+
+	salida_ma = reposo + (uint16_t)(demanda * salida_escala / 255);
+
+	uint8_t escala = salida_brillo;
+	if (demanda * salida_brillo / 255 > disponible) escala = (uint8_t)((uint32_t)disponible * 255 / demanda);
+	salida_escala = escala;
+
+	salida_suma = 0;
+	// Umbral con bits invertidos del número de frame: reparte los redondeos en el tiempo
+	uint8_t f = ++salida_frame, u = 0;
+	for (uint8_t i = 0; i < 8; i++) { u = (u << 1) | (f & 1); f >>= 1; }
+	salida_umbral = u;
+	salida_ruido = 0;
+}
+
+// Cambia el brillo global; se aplica desde el próximo frame
+static inline void salida_set_brillo(uint8_t b) {
+	salida_brillo = b;
+	if (salida_escala > b) salida_escala = b;
+}
+
+#endif /* WS2812_SALIDA_H_ */